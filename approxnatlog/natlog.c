@@ -12,22 +12,61 @@ calculating the midpoint and adding it to the processors sum, and multiplying
 the sum by the width to get the area. Lastly, the root node will output the 
 value thats being computed, the estimated value of ln,the error in 
 computation to the actual ln value, and then the time of computation.
+
+Built with -DNATLOG_THREADS the same computation runs on pthreads in one
+process, without MPI, for callers that can not launch mpirun. Each thread
+takes a contiguous block of the segments instead of a cyclic share, is
+pinned to its own cpu, and writes its sum into a slot padded to a cache
+line so the threads never write to the same line. The main thread adds the
+slots up once the threads are joined. The number of threads is the optional
+third argument, the cpus the process may run on by default.
 Usage : natlog
 Build with: mpicc -Wall -g -o natlog natlog.c -lm
+            gcc -Wall -g -O2 -DNATLOG_THREADS -pthread -o natlog natlog.c -lm
+Profile with: add -I../common ../common/mpi_profile.c to the mpicc line, the
+table of MPI and compute time per processor is printed on stderr at the end
 Execute with:
 mpirun --use-hwthread-cpus natlog (computation#) (#ofsegments) 2> /dev/null
+natlog (computation#) (#ofsegments) [#ofthreads] (threads build)
 Modifications: March 7, 2023 (added error checking)
+               October 18, 2026 (pthreads backend with -DNATLOG_THREADS)
 ******************************************************************************/
 
+#ifdef NATLOG_THREADS
+#define _GNU_SOURCE
+#endif
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <ctype.h>
 #include <math.h>
+#ifdef NATLOG_THREADS
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#else
 #include "mpi.h"
+#endif
 
 #define ROOT 0
+#define CACHE_LINE 64 //bytes of a cache line, size of a partial sum slot
+
+#ifdef NATLOG_THREADS
+typedef struct partial_sum{
+    double area; //area of the thread's block of segments
+    char pad[CACHE_LINE - sizeof(double)]; //fills the rest of the line
+} partial_sum;
+
+typedef struct ln_thread{
+    int id; //index of the thread
+    int p; //number of threads
+    int num_segments; //segments of the whole computation
+    int upper; //value of ln computation
+    int cpu; //cpu the thread is pinned to, -1 to leave it unpinned
+    partial_sum* partial; //slot the thread writes its area into
+} ln_thread;
+#endif
 
 double approximate_ln (int num_segments, int id, int p, int upper);
 /**
@@ -45,6 +84,42 @@ double approximate_ln (int num_segments, int id, int p, int upper);
  * @return: double of the approximate value of ln of int upper
 */
 
+double approximate_ln_range (int num_segments, int first, int last,
+                             int stride, int upper);
+/**
+ * @param: int number of segments, int first and last (excluded) segment
+ * index, int step between two segments, value of ln computation
+ *
+ * @brief: rectangle rule of approximate_ln over the segments first + 1,
+ * first + 1 + stride, ... up to last of the num_segments segments between
+ * 1 and upper. The cyclic share of a processor and the block of a thread
+ * both go through it
+ * 
+ * @return: double of the area of those segments
+*/
+
+#ifdef NATLOG_THREADS
+void * ln_worker(void * arg);
+/**
+ * @param: void pointer of the thread's ln_thread
+ *
+ * @brief: pins the thread to its cpu, computes the area of its block of
+ * segments and stores it in its partial sum slot
+ * 
+*/
+
+double threaded_ln(int num_segments, int p, int upper);
+/**
+ * @param: int number of segments, int number of threads, value of ln
+ * computation
+ *
+ * @brief: starts the threads on contiguous blocks of the segments, one per
+ * allowed cpu in turn, joins them and adds their slots up in order
+ * 
+ * @return: double of the approximate value of ln of int upper
+*/
+#endif
+
 void input_validation(char* input,int id);
 /**
  * @param: string input, int processor id
@@ -65,6 +140,58 @@ void print_error(char* error_message, int id);
  * 
 */
 
+#ifdef NATLOG_THREADS
+int main(int argc, char *argv[]){
+
+    double ln_estimate; //estimate of the ln at a given value
+    double error; //calculate error between estimate and actual value
+    double elapsed_time; //calculate elapsed time of total computation time
+    struct timespec start, end; //wall clock around the computation
+    int p; //number of threads
+
+    if(3 != argc && 4 != argc){
+        //throw error for invalid command line arguments
+        print_error("Insufficient command line arguments!",ROOT);
+    }
+    //check the two given command line arguments
+    input_validation(argv[1],ROOT);
+    input_validation(argv[2],ROOT);
+
+    double computing_number = atof(argv[1]); //# of ln computation
+    int num_segments = atof(argv[2]);     /* numbers of terms in series   */
+    if(4 == argc){
+        //a count of threads is whole, atoi would cut 2.5 down to 2
+        if(NULL != strchr(argv[3], '.')){
+            print_error("Number of threads has to be a whole number!",ROOT);
+        }
+        input_validation(argv[3],ROOT);
+        p = atoi(argv[3]);
+        if(p < 1){
+            print_error("Number of threads has to be at least one!",ROOT);
+        }
+    }else{
+        cpu_set_t allowed;
+        sched_getaffinity(0, sizeof(cpu_set_t), &allowed);
+        p = CPU_COUNT(&allowed);
+    }
+
+    //START TIMER!
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    ln_estimate = threaded_ln(num_segments, p, computing_number);
+
+    //END TIMER!
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed_time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    error = log(computing_number) - ln_estimate;
+    printf("%.16g\t%.16f\t%.16f\t%.6f seconds\n",
+           computing_number,ln_estimate, error, elapsed_time);
+    fflush(stdout);
+    return 0;
+
+}
+#else
 int main(int argc, char *argv[]){
   
     //validate the correct number of command line arguments was given.
@@ -116,8 +243,16 @@ int main(int argc, char *argv[]){
     return 0;
 
 }
+#endif
 
 double approximate_ln (int num_segments, int id, int p, int upper){
+
+    //every p-th segment starting at the processor's id
+    return approximate_ln_range(num_segments, id, num_segments, p, upper);
+}
+
+double approximate_ln_range (int num_segments, int first, int last,
+                             int stride, int upper){
 	
     double dx, midpoint;
 
@@ -126,14 +261,82 @@ double approximate_ln (int num_segments, int id, int p, int upper){
     
     double sum = 0.0;
 
-    //loop through the number of segments and add 1/(midpoint) to the sum
-    for(int i = id + 1; i <= num_segments; i+=p){
+    //loop through the segments and add 1/(midpoint) to the sum
+    for(int i = first + 1; i <= last; i+=stride){
         midpoint = 1 + dx*((double)i - 0.5);
         sum += 1/midpoint;
     }
 
-    return dx * sum; //return the total area (width * total height)
+    return dx * sum; //return the area (width * total height)
+}
+
+#ifdef NATLOG_THREADS
+
+void * ln_worker(void * arg){
+    ln_thread* self = (ln_thread *)arg;
+
+    //pinning is best effort, the sum is right on any cpu
+    if(self->cpu >= 0){
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(self->cpu, &cpus);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+    }
+
+    //block of segments, sizes differ by at most one
+    int first = ((long long)self->id * self->num_segments) / self->p;
+    int last = ((long long)(self->id + 1) * self->num_segments) / self->p;
+    self->partial->area = approximate_ln_range(self->num_segments, first, last,
+                                               1, self->upper);
+    return NULL;
+}
+
+double threaded_ln(int num_segments, int p, int upper){
+
+    //cpus the process may run on, the threads are pinned to them in turn
+    cpu_set_t allowed;
+    int cpus[CPU_SETSIZE];
+    int num_cpus = 0;
+    if(0 == sched_getaffinity(0, sizeof(cpu_set_t), &allowed)){
+        for(int c = 0; c < CPU_SETSIZE; c++){
+            if(CPU_ISSET(c, &allowed)){
+                cpus[num_cpus++] = c;
+            }
+        }
+    }
+
+    pthread_t* threads = (pthread_t *)malloc(p * sizeof(pthread_t));
+    ln_thread* tasks = (ln_thread *)malloc(p * sizeof(ln_thread));
+    //one cache line per slot, aligned so no two slots share a line
+    partial_sum* partials = (partial_sum *)aligned_alloc(CACHE_LINE, p * sizeof(partial_sum));
+    if(threads == NULL || tasks == NULL || partials == NULL){
+        print_error("Thread memory allocation failed!",ROOT);
+    }
+
+    for(int t = 0; t < p; t++){
+        tasks[t].id = t;
+        tasks[t].p = p;
+        tasks[t].num_segments = num_segments;
+        tasks[t].upper = upper;
+        tasks[t].cpu = num_cpus > 0 ? cpus[t % num_cpus] : -1;
+        tasks[t].partial = &partials[t];
+        if(0 != pthread_create(&threads[t], NULL, ln_worker, &tasks[t])){
+            print_error("Thread creation failed!",ROOT);
+        }
+    }
+
+    double sum = 0.0;
+    for(int t = 0; t < p; t++){
+        pthread_join(threads[t], NULL);
+        sum += partials[t].area;
+    }
+
+    free(threads);
+    free(tasks);
+    free(partials);
+    return sum;
 }
+#endif
 
 void input_validation(char* input,int id){
 
@@ -165,6 +368,8 @@ void print_error(char* error_message, int id){
         printf("%s\n",error_message);
         fflush(stdout);
     }
+#ifndef NATLOG_THREADS
     MPI_Finalize();
+#endif
     exit(EXIT_FAILURE);
 }
@@ -0,0 +1,218 @@
+#!/bin/bash
+###############################################################################
+# Title : bench.sh
+# Author : Anton Ha
+# Created on : October 18, 2026
+#
+# Description : Benchmark driver of steady, search, redact and natlog. It
+# builds the programs and generate.c into a work directory, generates the
+# inputs from fixed seeds, runs every benchmark at every processor / thread
+# count a few times and keeps the median wall time. Each run's output is
+# checked where the answer is known (search and redact know how many times
+# the pattern was planted), so a fast wrong program does not pass. Results
+# go to a CSV file, one line per benchmark and count:
+#   benchmark,procs,seconds,throughput,unit,speedup
+# seconds is the median latency of a run, throughput is work per second
+# (bytes for search and redact, inner points for steady, segments for natlog)
+# and speedup is against the smallest count of the same benchmark. With
+# --baseline the results are compared with a CSV written before by --save,
+# and the script fails when a throughput dropped by more than the threshold.
+#
+# Usage : bench.sh
+# Execute with:
+# ./bench.sh [--quick] [--repeat <n>] [--procs "<counts>"] [--threshold <fraction>]
+#            [--out <csv>] [--save <csv>] [--baseline <csv>]
+# MPIRUN and MPIRUN_FLAGS pick the launcher, e.g.
+# MPIRUN_FLAGS="--oversubscribe" ./bench.sh --quick
+###############################################################################
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+REPO=$(dirname "$HERE")
+WORK=${BENCH_WORK:-$HERE/_work} #build and input directory
+MPIRUN=${MPIRUN:-mpirun}
+MPIRUN_FLAGS=${MPIRUN_FLAGS:-}
+
+QUICK=0 #small inputs to check the suite itself
+REPEAT=3 #runs of every benchmark, the median is kept
+PROCS="1 2 4" #processor / thread counts
+THRESHOLD=0.15 #largest throughput drop against the baseline
+OUT=$WORK/results.csv
+SAVE=""
+BASELINE=""
+
+usage(){
+    echo "Usage: $0 [--quick] [--repeat <n>] [--procs \"<counts>\"] [--threshold <fraction>]" >&2
+    echo "          [--out <csv>] [--save <csv>] [--baseline <csv>]" >&2
+    exit 1
+}
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --quick) QUICK=1; shift ;;
+        --repeat) [ $# -ge 2 ] || usage; REPEAT=$2; shift 2 ;;
+        --procs) [ $# -ge 2 ] || usage; PROCS=$2; shift 2 ;;
+        --threshold) [ $# -ge 2 ] || usage; THRESHOLD=$2; shift 2 ;;
+        --out) [ $# -ge 2 ] || usage; OUT=$2; shift 2 ;;
+        --save) [ $# -ge 2 ] || usage; SAVE=$2; shift 2 ;;
+        --baseline) [ $# -ge 2 ] || usage; BASELINE=$2; shift 2 ;;
+        *) usage ;;
+    esac
+done
+
+if [ $QUICK -eq 1 ]; then
+    TEXT_SIZES="4194304"
+    PLATES="12x12"
+    SEGMENTS=10000000
+else
+    TEXT_SIZES="16777216 67108864"
+    PLATES="20x20 40x40"
+    SEGMENTS=200000000
+fi
+DENSITIES="10 1000" #planted patterns per MiB
+PATTERN="qzwx" #holds a z, so it only occurs where it was planted
+FAILED=0
+
+fail(){
+    echo "FAIL: $*" >&2
+    FAILED=1
+}
+
+# build the programs the way their headers say
+build(){
+    mkdir -p "$WORK"
+    local common=$REPO/common
+    gcc -Wall -O2 -o "$WORK/generate" "$HERE/generate.c" &&
+    mpicc -Wall -O2 -I"$common" -o "$WORK/steady" "$REPO/steadytemp/steady.c" \
+          "$common/collectives.c" &&
+    mpicc -Wall -O2 -pthread -I"$common" -o "$WORK/search" "$REPO/search/search.c" \
+          "$common/match.c" "$common/aho_corasick.c" "$common/varint.c" \
+          "$common/regex_dfa.c" "$common/ngram_index.c" "$common/collectives.c" &&
+    gcc -Wall -O2 -pthread -I"$common" -o "$WORK/redact" "$REPO/thread/redact.c" \
+        "$common/match.c" "$common/aho_corasick.c" "$common/work_pool.c" &&
+    mpicc -Wall -O2 -o "$WORK/natlog" "$REPO/approxnatlog/natlog.c" -lm &&
+    gcc -Wall -O2 -DNATLOG_THREADS -pthread -o "$WORK/natlog_threads" \
+        "$REPO/approxnatlog/natlog.c" -lm
+}
+
+# seconds since the epoch with nanoseconds
+now(){
+    date +%s.%N
+}
+
+# median of the numbers on stdin
+median(){
+    sort -g | awk '{ v[NR] = $1 } END { print (NR % 2) ? v[(NR + 1) / 2] : (v[NR / 2] + v[NR / 2 + 1]) / 2 }'
+}
+
+# time_runs <name> <procs> <work> <unit> <command...>
+# runs the command REPEAT times, its stdout goes to $WORK/last.out
+time_runs(){
+    local name=$1 procs=$2 work=$3 unit=$4
+    shift 4
+    local times=""
+    for ((r = 0; r < REPEAT; r++)); do
+        local start=$(now)
+        if ! "$@" > "$WORK/last.out" 2> "$WORK/last.err"; then
+            fail "$name with $procs: $(head -c 200 "$WORK/last.err")"
+            return 1
+        fi
+        times="$times $(awk -v a=$(now) -v b=$start 'BEGIN { print a - b }')"
+    done
+    local seconds=$(echo $times | tr ' ' '\n' | median)
+    echo "$name,$procs,$seconds,$(awk -v w=$work -v s=$seconds 'BEGIN { print w / s }'),$unit" >> "$WORK/raw.csv"
+}
+
+run_search(){
+    for size in $TEXT_SIZES; do
+        for density in $DENSITIES; do
+            local input=$WORK/text_${size}_${density}.txt
+            local planted=$("$WORK/generate" text $size $PATTERN $density 1 "$input")
+            for p in $PROCS; do
+                time_runs "search_${size}_${density}" $p $size bytes \
+                    $MPIRUN $MPIRUN_FLAGS -np $p "$WORK/search" --count-only $PATTERN "$input"
+                [ "$(cat "$WORK/last.out")" == "$planted" ] ||
+                    fail "search_${size}_${density} with $p found $(cat "$WORK/last.out") of $planted"
+            done
+        done
+    done
+}
+
+run_redact(){
+    for size in $TEXT_SIZES; do
+        for density in $DENSITIES; do
+            local input=$WORK/text_${size}_${density}.txt
+            local planted=$("$WORK/generate" text $size $PATTERN $density 1 "$input")
+            for p in $PROCS; do
+                time_runs "redact_${size}_${density}" $p $size bytes \
+                    "$WORK/redact" $p $PATTERN "$input" "$WORK/redacted.txt"
+                #no occurence may be left, and none of the text may be lost
+                local left=$(grep -o $PATTERN "$WORK/redacted.txt" | wc -l)
+                [ $left -eq 0 ] && [ $(stat -c %s "$WORK/redacted.txt") -eq $size ] ||
+                    fail "redact_${size}_${density} with $p left $left of $planted"
+            done
+        done
+    done
+}
+
+run_steady(){
+    for plate in $PLATES; do
+        local rows=${plate%x*} cols=${plate#*x}
+        local input=$WORK/plate_$plate.txt
+        "$WORK/generate" plate $rows $cols 1 "$input"
+        #one walk per inner point per sweep, the sweeps are not known up front,
+        #so throughput is inner points per second
+        local work=$(( (rows - 2) * (cols - 2) ))
+        for p in $PROCS; do
+            time_runs "steady_$plate" $p $work points \
+                $MPIRUN $MPIRUN_FLAGS -np $p "$WORK/steady" "$input" $((cols / 2)) $((rows / 2))
+        done
+    done
+}
+
+run_natlog(){
+    "$WORK/generate" natlog 1 $SEGMENTS 1 > "$WORK/natlog_args.txt"
+    local value=$(cut -d ' ' -f 1 "$WORK/natlog_args.txt")
+    for p in $PROCS; do
+        time_runs "natlog_mpi" $p $SEGMENTS segments \
+            $MPIRUN $MPIRUN_FLAGS -np $p "$WORK/natlog" $value $SEGMENTS
+        time_runs "natlog_threads" $p $SEGMENTS segments \
+            "$WORK/natlog_threads" $value $SEGMENTS $p
+    done
+}
+
+# adds the speedup against the smallest count of every benchmark
+write_results(){
+    echo "benchmark,procs,seconds,throughput,unit,speedup" > "$OUT"
+    awk -F, '{ if(!($1 in first)) first[$1] = $3; printf "%s,%s,%.6f,%.1f,%s,%.3f\n", $1, $2, $3, $4, $5, first[$1] / $3 }' \
+        "$WORK/raw.csv" >> "$OUT"
+}
+
+# fails on throughputs below (1 - THRESHOLD) of the baseline
+compare_baseline(){
+    awk -F, -v threshold=$THRESHOLD '
+        NR == FNR { if(FNR > 1) base[$1 "," $2] = $4; next }
+        FNR > 1 && ($1 "," $2) in base {
+            ratio = $4 / base[$1 "," $2]
+            status = (ratio < 1 - threshold) ? "REGRESSION" : "ok"
+            printf "%-28s %4s %8.3f %s\n", $1, $2, ratio, status
+            if(status != "ok") bad = 1
+        }
+        END { exit bad }' "$BASELINE" "$OUT"
+}
+
+build || { echo "Build failed!" >&2; exit 1; }
+rm -f "$WORK/raw.csv"
+run_search
+run_redact
+run_steady
+run_natlog
+write_results
+cat "$OUT"
+if [ -n "$SAVE" ]; then
+    cp "$OUT" "$SAVE"
+fi
+if [ -n "$BASELINE" ]; then
+    echo "throughput against $BASELINE:"
+    compare_baseline || fail "throughput dropped more than $THRESHOLD against the baseline"
+fi
+exit $FAILED
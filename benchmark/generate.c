@@ -0,0 +1,217 @@
+/******************************************************************************
+Title : generate.c
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Deterministic input generators of the benchmark suite. Every
+input comes from a seed through splitmix64, not rand(), so the same seed
+gives the same bytes on every machine and every C library, and benchmark
+runs on different days measure the same work.
+plate writes a steady plate spec: the rows and cols followed by the north,
+west, east and south temperatures, drawn between 0 and 100.
+text writes a corpus of random lowercase words and spaces with the pattern
+planted at a controlled density, a given number of times per MiB at evenly
+spread spots moved by the seed. The letters are drawn from a-y, never z,
+so a pattern holding a z only occurs where it was planted and the number of
+occurences is exactly known; it is printed on stdout.
+natlog prints argument sets of natlog, one "<value> <segments>" per line.
+
+Usage : generate
+Build with: gcc -Wall -O2 -o generate generate.c
+Execute with:
+./generate plate <rows> <cols> <seed> <file>
+./generate text <bytes> <pattern> <occurences per MiB> <seed> <file>
+./generate natlog <count> <segments> <seed>
+******************************************************************************/
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#define TEXT_BLOCK 65536 //bytes of text generated and written at a time
+#define MIB (1 << 20) //bytes of a MiB
+
+uint64_t next_random(uint64_t* state);
+/**
+ * @param: state of the generator, advanced
+ *
+ * @brief: splitmix64, a fast generator whose output only depends on the seed
+ *
+ * @return: uint64_t next random number
+*/
+int generate_plate(int rows, int cols, uint64_t seed, char* file_name);
+/**
+ * @param: rows and cols of the plate, seed, output file name
+ *
+ * @brief: writes a plate spec with random boundary temperatures
+ *
+ * @return: 0 on success, -1 if the file could not be written
+*/
+int generate_text(int64_t bytes, char* pattern, int64_t density, uint64_t seed,
+                  char* file_name);
+/**
+ * @param: size of the corpus, pattern to plant, occurences per MiB, seed,
+ *         output file name
+ *
+ * @brief: writes the corpus block by block with the pattern planted at
+ * spots that never overlap, and prints how many times it was planted
+ *
+ * @return: 0 on success, -1 if the file could not be written
+*/
+void generate_natlog(int count, int64_t segments, uint64_t seed);
+/**
+ * @param: number of argument sets, segments of each, seed
+ *
+ * @brief: prints values between 2 and 1000 with the segment count
+*/
+int64_t parse_number(char* text);
+/**
+ * @param: string of digits
+ *
+ * @brief: checks the string is a non negative number
+ *
+ * @return: int64_t the number, -1 if the string is not one
+*/
+void print_usage(void);
+/**
+ * @brief: prints the usage and exits the program
+*/
+
+int main(int argc, char *argv[]){
+    if(argc < 2){
+        print_usage();
+    }
+    if(strcmp(argv[1], "plate") == 0 && argc == 6){
+        int64_t rows = parse_number(argv[2]);
+        int64_t cols = parse_number(argv[3]);
+        int64_t seed = parse_number(argv[4]);
+        if(rows < 3 || cols < 3 || seed < 0){
+            print_usage();
+        }
+        return (generate_plate(rows, cols, seed, argv[5]) == 0) ? 0 : 1;
+    }else if(strcmp(argv[1], "text") == 0 && argc == 7){
+        int64_t bytes = parse_number(argv[2]);
+        int64_t density = parse_number(argv[4]);
+        int64_t seed = parse_number(argv[5]);
+        if(bytes < 0 || density < 0 || seed < 0 || strlen(argv[3]) == 0){
+            print_usage();
+        }
+        return (generate_text(bytes, argv[3], density, seed, argv[6]) == 0) ? 0 : 1;
+    }else if(strcmp(argv[1], "natlog") == 0 && argc == 5){
+        int64_t count = parse_number(argv[2]);
+        int64_t segments = parse_number(argv[3]);
+        int64_t seed = parse_number(argv[4]);
+        if(count < 0 || segments < 1 || seed < 0){
+            print_usage();
+        }
+        generate_natlog(count, segments, seed);
+        return 0;
+    }
+    print_usage();
+    return 1;
+}
+
+uint64_t next_random(uint64_t* state){
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+int generate_plate(int rows, int cols, uint64_t seed, char* file_name){
+    FILE* file = fopen(file_name, "w");
+    if(file == NULL){
+        fprintf(stderr, "Couldn't write the file %s!\n", file_name);
+        return -1;
+    }
+    uint64_t state = seed;
+    fprintf(file, "%d %d", rows, cols);
+    for(int side = 0; side < 4; side++){
+        fprintf(file, " %d", (int)(next_random(&state) % 101));
+    }
+    fprintf(file, "\n");
+    fclose(file);
+    return 0;
+}
+
+int generate_text(int64_t bytes, char* pattern, int64_t density, uint64_t seed,
+                  char* file_name){
+    int64_t length = strlen(pattern);
+    FILE* file = fopen(file_name, "w");
+    if(file == NULL){
+        fprintf(stderr, "Couldn't write the file %s!\n", file_name);
+        return -1;
+    }
+    //spots are evenly spaced, each one moved inside its slot by the seed and
+    //followed by at least length random bytes, so copies never touch
+    int64_t planted = (density * bytes) / MIB;
+    if(planted > bytes / (2 * length)){
+        planted = bytes / (2 * length);
+    }
+    int64_t slot = planted ? bytes / planted : 0; //bytes between spots
+    uint64_t state = seed;
+    char block[TEXT_BLOCK + 1];
+    int64_t next_spot = -1; //index the next planted pattern starts at
+    int64_t spot_number = 0; //planted patterns so far
+    if(planted > 0){
+        next_spot = next_random(&state) % (slot - 2 * length + 1);
+    }
+    int64_t pending = 0; //bytes of a planted pattern left for the next block
+    for(int64_t written = 0; written < bytes; ){
+        int64_t size = (bytes - written < TEXT_BLOCK) ? bytes - written : TEXT_BLOCK;
+        for(int64_t i = 0; i < size; i++){
+            uint64_t r = next_random(&state);
+            //words of about six letters between single spaces
+            block[i] = (r % 7 == 0) ? ' ' : 'a' + (r >> 8) % 25;
+        }
+        //finish a pattern cut by the previous block, then plant the new ones
+        if(pending > 0){
+            memcpy(block, pattern + length - pending, pending);
+            pending = 0;
+        }
+        while(spot_number < planted && next_spot < written + size){
+            int64_t at = next_spot - written;
+            int64_t fits = (size - at < length) ? size - at : length;
+            memcpy(block + at, pattern, fits);
+            pending = length - fits;
+            spot_number++;
+            next_spot = spot_number * slot + next_random(&state) % (slot - 2 * length + 1);
+        }
+        if(fwrite(block, 1, size, file) != size){
+            fprintf(stderr, "Couldn't write the file %s!\n", file_name);
+            fclose(file);
+            return -1;
+        }
+        written += size;
+    }
+    fclose(file);
+    printf("%lld\n", (long long)planted);
+    return 0;
+}
+
+void generate_natlog(int count, int64_t segments, uint64_t seed){
+    uint64_t state = seed;
+    for(int i = 0; i < count; i++){
+        printf("%d %lld\n", 2 + (int)(next_random(&state) % 999), (long long)segments);
+    }
+}
+
+int64_t parse_number(char* text){
+    if(*text == '\0'){
+        return -1;
+    }
+    for(char* c = text; *c != '\0'; c++){
+        if(!isdigit(*c)){
+            return -1;
+        }
+    }
+    return atoll(text);
+}
+
+void print_usage(void){
+    fprintf(stderr, "Usage: generate plate <rows> <cols> <seed> <file>\n"
+                    "       generate text <bytes> <pattern> <occurences per MiB> <seed> <file>\n"
+                    "       generate natlog <count> <segments> <seed>\n");
+    exit(1);
+}
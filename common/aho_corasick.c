@@ -0,0 +1,287 @@
+/******************************************************************************
+Title : aho_corasick.c
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Implementation of the automaton described in aho_corasick.h.
+A transition into a state that reports patterns is stored negated (~state),
+so the scan loop finds out whether it has to report with the same load that
+gives it the next state.
+
+Build with: compile aho_corasick.c along with the program using it
+******************************************************************************/
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "aho_corasick.h"
+
+#define AC_MAGIC 0x41434b31 //"ACK1", marks a valid automaton block
+#define AC_HEADER 6 //int32 fields at the start of the block
+
+static size_t block_layout(int32_t num_states, int32_t num_classes,
+                           int32_t num_patterns, int32_t num_outputs);
+/**
+ * @param: number of states, classes, patterns and outputs of the automaton
+ *
+ * @brief: computes how many bytes the block of an automaton of that shape
+ * needs, arrays follow each other in the order of the ac_automaton fields
+ *
+ * @return: size_t size of the block in bytes
+ *
+*/
+static void point_arrays(ac_automaton* ac, int32_t num_outputs);
+/**
+ * @param: automaton whose block and sizes are set, number of outputs
+ *
+ * @brief: points every array of the automaton to its place in the block
+ *
+*/
+
+int ac_build(ac_automaton* ac, char** patterns, const size_t* lengths, int count){
+    return ac_build_flags(ac, patterns, lengths, count, 0);
+}
+
+int ac_build_flags(ac_automaton* ac, char** patterns, const size_t* lengths,
+                   int count, int flags){
+    memset(ac, 0, sizeof(ac_automaton));
+    if(count <= 0){
+        return -1;
+    }
+
+    //give every byte used by a pattern its own class, everything else is 0
+    unsigned char byte_class[256]; //byte -> class
+    int32_t num_classes = 1;
+    size_t total_length = 0; //sum of the pattern lengths, bounds the states
+    int32_t max_length = 0;
+    memset(byte_class, 0, sizeof(byte_class));
+    for(int i = 0; i < count; i++){
+        if(lengths[i] == 0 || lengths[i] > INT32_MAX){
+            return -1;
+        }
+        for(size_t j = 0; j < lengths[i]; j++){
+            unsigned char c = patterns[i][j];
+            if((flags & AC_IGNORE_CASE) && c >= 'A' && c <= 'Z'){
+                c += 'a' - 'A';
+            }
+            if(byte_class[c] == 0){
+                byte_class[c] = num_classes++;
+            }
+        }
+        total_length += lengths[i];
+        if((int32_t)lengths[i] > max_length){
+            max_length = lengths[i];
+        }
+    }
+    if(flags & AC_IGNORE_CASE){
+        //upper case letters share the class of their lower case letter
+        for(int c = 'A'; c <= 'Z'; c++){
+            byte_class[c] = byte_class[c + ('a' - 'A')];
+        }
+    }
+    if(total_length >= (size_t)(INT32_MAX / num_classes)){
+        return -1;
+    }
+
+    //build the trie, the dense table doubles as the DFA transitions later
+    int32_t max_states = total_length + 1;
+    int32_t* table = (int32_t *)malloc((size_t)max_states * num_classes * sizeof(int32_t));
+    int32_t* terminal = (int32_t *)malloc(count * sizeof(int32_t)); //state of each pattern
+    int32_t* fail = (int32_t *)malloc(max_states * sizeof(int32_t));
+    int32_t* queue = (int32_t *)malloc(max_states * sizeof(int32_t));
+    int32_t* own = (int32_t *)calloc(max_states + 1, sizeof(int32_t)); //outputs per state
+    if(table == NULL || terminal == NULL || fail == NULL || queue == NULL || own == NULL){
+        free(table);
+        free(terminal);
+        free(fail);
+        free(queue);
+        free(own);
+        return -1;
+    }
+    memset(table, -1, (size_t)max_states * num_classes * sizeof(int32_t));
+    int32_t num_states = 1;
+    for(int i = 0; i < count; i++){
+        int32_t state = 0;
+        for(size_t j = 0; j < lengths[i]; j++){
+            int32_t* edge = &table[(size_t)state * num_classes +
+                                   byte_class[(unsigned char)patterns[i][j]]];
+            if(*edge == -1){
+                *edge = num_states++;
+            }
+            state = *edge;
+        }
+        terminal[i] = state;
+        own[state + 1]++;
+    }
+    for(int32_t s = 0; s < num_states; s++){
+        own[s + 1] += own[s];
+    }
+    int32_t num_outputs = own[num_states];
+
+    ac->num_states = num_states;
+    ac->num_classes = num_classes;
+    ac->num_patterns = count;
+    ac->max_length = max_length;
+    ac->block_size = block_layout(num_states, num_classes, count, num_outputs);
+    ac->block = (char *)malloc(ac->block_size);
+    if(ac->block == NULL){
+        free(table);
+        free(terminal);
+        free(fail);
+        free(queue);
+        free(own);
+        return -1;
+    }
+    int32_t* header = (int32_t *)ac->block;
+    header[0] = AC_MAGIC;
+    header[1] = num_states;
+    header[2] = num_classes;
+    header[3] = count;
+    header[4] = max_length;
+    header[5] = num_outputs;
+    point_arrays(ac, num_outputs);
+    int32_t* next = (int32_t *)ac->next;
+    int32_t* out_start = (int32_t *)ac->out_start;
+    int32_t* out_ids = (int32_t *)ac->out_ids;
+    int32_t* dict = (int32_t *)ac->dict;
+    int32_t* pattern_lengths = (int32_t *)ac->lengths;
+    memcpy((unsigned char *)ac->byte_class, byte_class, sizeof(byte_class));
+
+    //own outputs of each state, in pattern id order
+    memcpy(out_start, own, (num_states + 1) * sizeof(int32_t));
+    for(int i = 0; i < count; i++){
+        out_ids[own[terminal[i]]++] = i;
+        pattern_lengths[i] = lengths[i];
+    }
+
+    //breadth first failure links, missing edges follow the failure link
+    int32_t head = 0, tail = 0;
+    fail[0] = 0;
+    dict[0] = -1;
+    for(int32_t c = 0; c < num_classes; c++){
+        int32_t child = table[c];
+        if(child == -1){
+            table[c] = 0;
+        }else{
+            fail[child] = 0;
+            queue[tail++] = child;
+        }
+    }
+    while(head < tail){
+        int32_t s = queue[head++];
+        int32_t f = fail[s];
+        //nearest proper suffix that reports something
+        dict[s] = (out_start[f + 1] > out_start[f]) ? f : dict[f];
+        for(int32_t c = 0; c < num_classes; c++){
+            int32_t* edge = &table[(size_t)s * num_classes + c];
+            int32_t target = table[(size_t)f * num_classes + c];
+            if(*edge == -1){
+                *edge = target;
+            }else{
+                fail[*edge] = target;
+                queue[tail++] = *edge;
+            }
+        }
+    }
+
+    //negate transitions into states that report, so the scan needs one load
+    for(size_t e = 0; e < (size_t)num_states * num_classes; e++){
+        int32_t target = table[e];
+        if(out_start[target + 1] > out_start[target] || dict[target] != -1){
+            next[e] = ~target;
+        }else{
+            next[e] = target;
+        }
+    }
+
+    free(table);
+    free(terminal);
+    free(fail);
+    free(queue);
+    free(own);
+    return 0;
+}
+
+int ac_attach(ac_automaton* ac, char* block, size_t block_size){
+    memset(ac, 0, sizeof(ac_automaton));
+    if(block_size < AC_HEADER * sizeof(int32_t)){
+        return -1;
+    }
+    int32_t* header = (int32_t *)block;
+    if(header[0] != AC_MAGIC || header[1] <= 0 || header[2] <= 0 ||
+       header[3] <= 0 || header[5] < 0 ||
+       block_layout(header[1], header[2], header[3], header[5]) != block_size){
+        return -1;
+    }
+    ac->num_states = header[1];
+    ac->num_classes = header[2];
+    ac->num_patterns = header[3];
+    ac->max_length = header[4];
+    ac->block = block;
+    ac->block_size = block_size;
+    point_arrays(ac, header[5]);
+    return 0;
+}
+
+size_t ac_scan(const ac_automaton* ac, const char* text, size_t text_length,
+               size_t starts, ac_report report, void* arg){
+    size_t found = 0; //number of occurences
+    const unsigned char* t = (const unsigned char *)text;
+    const unsigned char* byte_class = ac->byte_class;
+    const int32_t* next = ac->next;
+    int32_t num_classes = ac->num_classes;
+    int32_t state = 0;
+
+    //bytes past this end only finish occurences that start after starts
+    size_t end = text_length;
+    if(starts < end && end - starts > (size_t)ac->max_length - 1){
+        end = starts + ac->max_length - 1;
+    }
+    for(size_t i = 0; i < end; i++){
+        state = next[(size_t)state * num_classes + byte_class[t[i]]];
+        if(state >= 0){
+            continue;
+        }
+        state = ~state;
+        //report the own patterns of this state and of its suffix chain
+        int32_t v = (ac->out_start[state + 1] > ac->out_start[state]) ? state : ac->dict[state];
+        while(v != -1){
+            for(int32_t k = ac->out_start[v]; k < ac->out_start[v + 1]; k++){
+                int32_t id = ac->out_ids[k];
+                size_t position = i + 1 - ac->lengths[id];
+                if(position < starts){
+                    report(id, position, arg);
+                    found++;
+                }
+            }
+            v = ac->dict[v];
+        }
+    }
+    return found;
+}
+
+void ac_free(ac_automaton* ac){
+    free(ac->block);
+    memset(ac, 0, sizeof(ac_automaton));
+}
+
+static size_t block_layout(int32_t num_states, int32_t num_classes,
+                           int32_t num_patterns, int32_t num_outputs){
+    return AC_HEADER * sizeof(int32_t) + 256 +
+           ((size_t)num_states * num_classes + (num_states + 1) +
+            num_outputs + num_states + num_patterns) * sizeof(int32_t);
+}
+
+static void point_arrays(ac_automaton* ac, int32_t num_outputs){
+    char* cur = ac->block + AC_HEADER * sizeof(int32_t);
+    ac->byte_class = (const unsigned char *)cur;
+    cur += 256;
+    ac->next = (const int32_t *)cur;
+    cur += (size_t)ac->num_states * ac->num_classes * sizeof(int32_t);
+    ac->out_start = (const int32_t *)cur;
+    cur += (ac->num_states + 1) * sizeof(int32_t);
+    ac->out_ids = (const int32_t *)cur;
+    cur += num_outputs * sizeof(int32_t);
+    ac->dict = (const int32_t *)cur;
+    cur += ac->num_states * sizeof(int32_t);
+    ac->lengths = (const int32_t *)cur;
+}
@@ -0,0 +1,109 @@
+/******************************************************************************
+Title : aho_corasick.h
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Aho-Corasick automaton for finding thousands of patterns in one
+pass over a text. The trie is compiled into a dense DFA whose alphabet is
+reduced to the byte classes that actually appear in the patterns, so each
+text byte costs one class lookup and one table lookup. Everything the scan
+needs lives in one contiguous block, which lets MPI programs build the
+automaton once on the root and broadcast the block as plain bytes.
+Ignoring case costs nothing at scan time: both cases of a letter are put in
+the same byte class.
+
+Build with: compile aho_corasick.c along with the program using it
+******************************************************************************/
+#ifndef AHO_CORASICK_H
+#define AHO_CORASICK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define AC_IGNORE_CASE 1 //flag of ac_build_flags, ASCII letters match either case
+
+typedef struct ac_automaton{
+    int32_t num_states; //number of DFA states, state 0 is the root
+    int32_t num_classes; //number of byte classes in the alphabet
+    int32_t num_patterns; //number of patterns
+    int32_t max_length; //length of the longest pattern
+    const unsigned char* byte_class; //byte -> class, 256 entries
+    const int32_t* next; //num_states * num_classes transitions
+    const int32_t* out_start; //num_states + 1 offsets into out_ids
+    const int32_t* out_ids; //ids of the patterns ending exactly at a state
+    const int32_t* dict; //nearest suffix state with output, -1 if none
+    const int32_t* lengths; //length of each pattern
+    char* block; //single allocation holding all arrays above
+    size_t block_size; //size of block in bytes
+} ac_automaton;
+
+typedef void (*ac_report)(int32_t pattern_id, size_t position, void* arg);
+/**
+ * @param: int32_t id of the pattern, size_t position where the occurence
+ *         starts in the scanned text, void pointer handed to ac_scan
+ *
+ * @brief: called once for every occurence of every pattern, ordered by the
+ * position where the occurence ends
+ *
+*/
+
+int ac_build(ac_automaton* ac, char** patterns, const size_t* lengths, int count);
+/**
+ * @param: automaton to build, array of patterns, array of their lengths,
+ *         number of patterns
+ *
+ * @brief: builds the trie, computes the failure links breadth first and
+ * folds them into a dense transition table. Pattern ids are the indexes
+ * into the patterns array
+ *
+ * @return: 0 on success, -1 if there are no patterns, a pattern is empty
+ * or memory ran out
+ *
+*/
+
+int ac_build_flags(ac_automaton* ac, char** patterns, const size_t* lengths,
+                   int count, int flags);
+/**
+ * @param: same as ac_build, 0 or AC_IGNORE_CASE
+ *
+ * @brief: same as ac_build, ac_build is ac_build_flags with 0
+ *
+ * @return: 0 on success, -1 like ac_build
+ *
+*/
+
+int ac_attach(ac_automaton* ac, char* block, size_t block_size);
+/**
+ * @param: automaton to fill in, block produced by ac_build (for example
+ *         received through a broadcast), size of the block
+ *
+ * @brief: points the automaton arrays into the block, the automaton takes
+ * ownership of the block and releases it in ac_free
+ *
+ * @return: 0 on success, -1 if the block is not a valid automaton
+ *
+*/
+
+size_t ac_scan(const ac_automaton* ac, const char* text, size_t text_length,
+               size_t starts, ac_report report, void* arg);
+/**
+ * @param: automaton, text to scan, length of the text, number of starting
+ *         positions owned by the caller, report callback and its argument
+ *
+ * @brief: scans the text once and reports every occurence that starts
+ * before starts. Like matcher_scan, callers splitting a text hand in
+ * max_length - 1 extra bytes after their share
+ *
+ * @return: number of occurences reported
+ *
+*/
+
+void ac_free(ac_automaton* ac);
+/**
+ * @param: automaton to release
+ *
+ * @brief: frees the block holding the automaton
+ *
+*/
+
+#endif
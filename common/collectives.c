@@ -0,0 +1,387 @@
+/******************************************************************************
+Title : collectives.c
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Implementation of the collectives described in collectives.h.
+Inside a node the processors reach the node's bytes through the window the
+leader allocated with MPI_Win_allocate_shared. They copy with plain memcpy
+inside a passive epoch of the whole window, MPI_Win_sync around a barrier
+of the node orders the copies of one processor before the reads of another.
+
+Build with: compile collectives.c along with the program using it
+******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "collectives.h"
+
+#define COLL_ROOT 0 //rank of comm gathering and scattering
+
+typedef struct node_window{
+    MPI_Win win; //shared window of the node, held by the leader
+    unsigned char* base; //start of the leader's bytes on this processor
+    int64_t* lengths; //bytes of every processor of the node, in node order
+    int64_t offset; //where this processor's bytes start in the window
+    int64_t total; //bytes of the whole node
+} node_window;
+
+static int open_window(coll_node* layout, int64_t length, node_window* window);
+/**
+ * @param: layout, bytes of this processor, window to fill in
+ *
+ * @brief: shares the node's lengths, allocates the shared window of the
+ * node's bytes on its leader and maps it on every processor of the node
+ *
+ * @return: 0 on success, COLL_NO_MEMORY on every processor of comm if
+ * memory ran out on one
+ *
+*/
+static void sync_window(coll_node* layout, node_window* window);
+/**
+ * @param: layout, window
+ *
+ * @brief: makes the copies into the window of every processor of the node
+ * visible to all of them
+ *
+*/
+static void close_window(node_window* window);
+/**
+ * @param: window
+ *
+ * @brief: ends the epoch and frees the window, every processor of the node
+ * calls
+ *
+*/
+static int leader_counts(coll_node* layout, node_window* window,
+                         int** counts, int** displs, int64_t** member_lengths);
+/**
+ * @param: layout, window, where the root stores the bytes of every node,
+ *         where they start and the bytes of every processor node by node
+ *
+ * @brief: gathers the bytes of every processor of every node on the root,
+ * leaders only
+ *
+ * @return: 0 on success, COLL_NO_MEMORY if memory ran out
+ *
+*/
+
+int coll_bcast_params(coll_param* params, int count, int root, MPI_Comm comm){
+    int* counts = malloc(count * sizeof(int));
+    MPI_Aint* addresses = malloc(count * sizeof(MPI_Aint));
+    MPI_Datatype* types = malloc(count * sizeof(MPI_Datatype));
+    if(counts == NULL || addresses == NULL || types == NULL){
+        free(counts);
+        free(addresses);
+        free(types);
+        return COLL_NO_MEMORY;
+    }
+    for(int i = 0; i < count; i++){
+        counts[i] = params[i].count;
+        MPI_Get_address(params[i].address, &addresses[i]);
+        types[i] = params[i].type;
+    }
+    //absolute addresses, so the struct is sent from MPI_BOTTOM and the
+    //parameters need not be next to each other
+    MPI_Datatype packed;
+    MPI_Type_create_struct(count, counts, addresses, types, &packed);
+    MPI_Type_commit(&packed);
+    MPI_Bcast(MPI_BOTTOM, 1, packed, root, comm);
+    MPI_Type_free(&packed);
+    free(counts);
+    free(addresses);
+    free(types);
+    return 0;
+}
+
+int coll_node_init(coll_node* layout, MPI_Comm comm){
+    memset(layout, 0, sizeof(coll_node));
+    layout->comm = comm;
+    MPI_Comm_rank(comm, &layout->rank);
+    MPI_Comm_size(comm, &layout->size);
+    //keyed by rank, so the lowest rank of a node leads it and the root is
+    //rank 0 among the leaders
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, layout->rank,
+                        MPI_INFO_NULL, &layout->node);
+    MPI_Comm_rank(layout->node, &layout->node_rank);
+    MPI_Comm_size(layout->node, &layout->node_size);
+    MPI_Comm_split(comm, (layout->node_rank == 0) ? 0 : MPI_UNDEFINED,
+                   layout->rank, &layout->leaders);
+    layout->members = malloc(layout->node_size * sizeof(int));
+    int failed = (layout->members == NULL);
+    MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, comm);
+    if(failed){
+        coll_node_free(layout);
+        return COLL_NO_MEMORY;
+    }
+    MPI_Allgather(&layout->rank, 1, MPI_INT, layout->members, 1, MPI_INT,
+                  layout->node);
+    int* displs = NULL;
+    if(layout->leaders != MPI_COMM_NULL){
+        MPI_Comm_size(layout->leaders, &layout->num_nodes);
+        if(layout->rank == COLL_ROOT){
+            layout->node_sizes = malloc(layout->num_nodes * sizeof(int));
+            layout->node_members = malloc(layout->size * sizeof(int));
+            displs = malloc(layout->num_nodes * sizeof(int));
+            failed = (layout->node_sizes == NULL || layout->node_members == NULL
+                      || displs == NULL);
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, comm);
+    if(failed){
+        free(displs);
+        coll_node_free(layout);
+        return COLL_NO_MEMORY;
+    }
+    if(layout->leaders != MPI_COMM_NULL){
+        MPI_Gather(&layout->node_size, 1, MPI_INT, layout->node_sizes, 1,
+                   MPI_INT, COLL_ROOT, layout->leaders);
+        if(layout->rank == COLL_ROOT){
+            displs[0] = 0;
+            for(int i = 1; i < layout->num_nodes; i++){
+                displs[i] = displs[i - 1] + layout->node_sizes[i - 1];
+            }
+        }
+        MPI_Gatherv(layout->members, layout->node_size, MPI_INT,
+                    layout->node_members, layout->node_sizes, displs, MPI_INT,
+                    COLL_ROOT, layout->leaders);
+    }
+    free(displs);
+    return 0;
+}
+
+int coll_gatherv_bytes(coll_node* layout, const void* send, int64_t length,
+                       unsigned char** gathered, int64_t** lengths,
+                       int64_t** offsets){
+    *gathered = NULL;
+    *lengths = NULL;
+    *offsets = NULL;
+    int64_t total;
+    MPI_Allreduce(&length, &total, 1, MPI_INT64_T, MPI_SUM, layout->comm);
+    if(total > INT_MAX){
+        return COLL_TOO_BIG;
+    }
+    node_window window;
+    if(open_window(layout, length, &window) != 0){
+        return COLL_NO_MEMORY;
+    }
+    if(length > 0){
+        memcpy(window.base + window.offset, send, length);
+    }
+    sync_window(layout, &window);
+    int failed = 0;
+    if(layout->leaders != MPI_COMM_NULL){
+        int* counts = NULL; //bytes of every node
+        int* displs = NULL; //where they start in gathered
+        int64_t* member_lengths = NULL; //bytes of every processor node by node
+        failed = (leader_counts(layout, &window, &counts, &displs,
+                                &member_lengths) != 0);
+        if(!failed && layout->rank == COLL_ROOT){
+            //every processor's bytes keep where its node put them, the
+            //lengths and offsets say where they are by rank
+            *gathered = malloc(total + 1);
+            *lengths = malloc(layout->size * sizeof(int64_t));
+            *offsets = malloc(layout->size * sizeof(int64_t));
+            failed = (*gathered == NULL || *lengths == NULL || *offsets == NULL);
+            int64_t offset = 0;
+            for(int i = 0; !failed && i < layout->size; i++){
+                (*lengths)[layout->node_members[i]] = member_lengths[i];
+                (*offsets)[layout->node_members[i]] = offset;
+                offset += member_lengths[i];
+            }
+        }
+        MPI_Bcast(&failed, 1, MPI_INT, COLL_ROOT, layout->leaders);
+        if(!failed){
+            MPI_Gatherv(window.base, window.total, MPI_BYTE, *gathered, counts,
+                        displs, MPI_BYTE, COLL_ROOT, layout->leaders);
+        }
+        free(counts);
+        free(displs);
+        free(member_lengths);
+    }
+    close_window(&window);
+    MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, layout->comm);
+    if(failed){
+        free(*gathered);
+        free(*lengths);
+        free(*offsets);
+        *gathered = NULL;
+        *lengths = NULL;
+        *offsets = NULL;
+        return COLL_NO_MEMORY;
+    }
+    return 0;
+}
+
+int coll_scatterv_bytes(coll_node* layout, const void* send,
+                        const int64_t* lengths, const int64_t* offsets,
+                        unsigned char** received, int64_t* length){
+    *received = NULL;
+    int64_t total = 0;
+    if(layout->rank == COLL_ROOT){
+        for(int i = 0; i < layout->size; i++){
+            total += lengths[i];
+        }
+    }
+    MPI_Bcast(&total, 1, MPI_INT64_T, COLL_ROOT, layout->comm);
+    if(total > INT_MAX){
+        *length = 0;
+        return COLL_TOO_BIG;
+    }
+    MPI_Scatter(lengths, 1, MPI_INT64_T, length, 1, MPI_INT64_T, COLL_ROOT,
+                layout->comm);
+    node_window window;
+    if(open_window(layout, *length, &window) != 0){
+        return COLL_NO_MEMORY;
+    }
+    int failed = 0;
+    if(layout->leaders != MPI_COMM_NULL){
+        int* counts = NULL; //bytes of every node
+        int* displs = NULL; //where they start in packed
+        int64_t* member_lengths = NULL; //bytes of every processor node by node
+        unsigned char* packed = NULL; //bytes of every node, node by node
+        failed = (leader_counts(layout, &window, &counts, &displs,
+                                &member_lengths) != 0);
+        if(!failed && layout->rank == COLL_ROOT){
+            packed = malloc(total + 1);
+            failed = (packed == NULL);
+            int64_t at = 0;
+            for(int i = 0; !failed && i < layout->size; i++){
+                int member = layout->node_members[i];
+                memcpy(packed + at, (const unsigned char*)send + offsets[member],
+                       lengths[member]);
+                at += lengths[member];
+            }
+        }
+        MPI_Bcast(&failed, 1, MPI_INT, COLL_ROOT, layout->leaders);
+        if(!failed){
+            MPI_Scatterv(packed, counts, displs, MPI_BYTE, window.base,
+                         window.total, MPI_BYTE, COLL_ROOT, layout->leaders);
+        }
+        free(counts);
+        free(displs);
+        free(member_lengths);
+        free(packed);
+    }
+    MPI_Bcast(&failed, 1, MPI_INT, 0, layout->node);
+    sync_window(layout, &window);
+    if(!failed){
+        *received = malloc(*length + 1);
+        failed = (*received == NULL);
+        if(!failed){
+            memcpy(*received, window.base + window.offset, *length);
+        }
+    }
+    close_window(&window);
+    MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, layout->comm);
+    if(failed){
+        free(*received);
+        *received = NULL;
+        return COLL_NO_MEMORY;
+    }
+    return 0;
+}
+
+void coll_node_free(coll_node* layout){
+    if(layout->node != MPI_COMM_NULL){
+        MPI_Comm_free(&layout->node);
+    }
+    if(layout->leaders != MPI_COMM_NULL){
+        MPI_Comm_free(&layout->leaders);
+    }
+    free(layout->members);
+    free(layout->node_sizes);
+    free(layout->node_members);
+    layout->members = NULL;
+    layout->node_sizes = NULL;
+    layout->node_members = NULL;
+}
+
+static int open_window(coll_node* layout, int64_t length, node_window* window){
+    window->lengths = malloc(layout->node_size * sizeof(int64_t));
+    int failed = (window->lengths == NULL);
+    //agreed over comm, the leaders of the other nodes would wait for this
+    //node in leader_counts
+    MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, layout->comm);
+    if(failed){
+        free(window->lengths);
+        return COLL_NO_MEMORY;
+    }
+    MPI_Allgather(&length, 1, MPI_INT64_T, window->lengths, 1, MPI_INT64_T,
+                  layout->node);
+    window->offset = 0;
+    window->total = 0;
+    for(int i = 0; i < layout->node_size; i++){
+        if(i < layout->node_rank){
+            window->offset += window->lengths[i];
+        }
+        window->total += window->lengths[i];
+    }
+    //a byte more, so an empty node still gets a window with an address
+    MPI_Aint size = (layout->node_rank == 0) ? window->total + 1 : 0;
+    MPI_Win_allocate_shared(size, 1, MPI_INFO_NULL, layout->node,
+                            &window->base, &window->win);
+    int disp_unit;
+    MPI_Win_shared_query(window->win, 0, &size, &disp_unit, &window->base);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, window->win);
+    return 0;
+}
+
+static void sync_window(coll_node* layout, node_window* window){
+    MPI_Win_sync(window->win);
+    MPI_Barrier(layout->node);
+    MPI_Win_sync(window->win);
+}
+
+static void close_window(node_window* window){
+    MPI_Win_unlock_all(window->win);
+    MPI_Win_free(&window->win);
+    free(window->lengths);
+}
+
+static int leader_counts(coll_node* layout, node_window* window,
+                         int** counts, int** displs, int64_t** member_lengths){
+    int failed = 0;
+    int* member_counts = NULL; //processors of every node, as Gatherv counts
+    int* member_displs = NULL; //where they start among all processors
+    if(layout->rank == COLL_ROOT){
+        *counts = malloc(layout->num_nodes * sizeof(int));
+        *displs = malloc(layout->num_nodes * sizeof(int));
+        *member_lengths = malloc(layout->size * sizeof(int64_t));
+        member_displs = malloc(layout->num_nodes * sizeof(int));
+        member_counts = layout->node_sizes;
+        failed = (*counts == NULL || *displs == NULL || *member_lengths == NULL
+                  || member_displs == NULL);
+        for(int i = 0; !failed && i < layout->num_nodes; i++){
+            member_displs[i] = (i == 0) ? 0
+                             : member_displs[i - 1] + layout->node_sizes[i - 1];
+        }
+    }
+    MPI_Bcast(&failed, 1, MPI_INT, COLL_ROOT, layout->leaders);
+    if(failed){
+        free(member_displs);
+        if(layout->rank == COLL_ROOT){
+            free(*counts);
+            free(*displs);
+            free(*member_lengths);
+            *counts = NULL;
+            *displs = NULL;
+            *member_lengths = NULL;
+        }
+        return COLL_NO_MEMORY;
+    }
+    int node_total = window->total;
+    MPI_Gather(&node_total, 1, MPI_INT, *counts, 1, MPI_INT, COLL_ROOT,
+               layout->leaders);
+    MPI_Gatherv(window->lengths, layout->node_size, MPI_INT64_T,
+                *member_lengths, member_counts, member_displs, MPI_INT64_T,
+                COLL_ROOT, layout->leaders);
+    if(layout->rank == COLL_ROOT){
+        (*displs)[0] = 0;
+        for(int i = 1; i < layout->num_nodes; i++){
+            (*displs)[i] = (*displs)[i - 1] + (*counts)[i - 1];
+        }
+    }
+    free(member_displs);
+    return 0;
+}
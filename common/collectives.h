@@ -0,0 +1,118 @@
+/******************************************************************************
+Title : collectives.h
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Collectives of the MPI programs that know about nodes.
+coll_bcast_params broadcasts any number of parameters of any types with one
+MPI_Bcast of a derived datatype built from their addresses, instead of one
+broadcast per parameter. The node layout splits the processors with
+MPI_Comm_split_type(MPI_COMM_TYPE_SHARED) into the ones sharing memory, the
+lowest rank of a node leads it, and the leaders get a communicator of their
+own. coll_gatherv_bytes and coll_scatterv_bytes move a variable number of
+bytes per processor in two levels: inside a node through an MPI-3 shared
+memory window that every processor of the node copies its bytes into (or
+out of), between nodes with one MPI_Gatherv (MPI_Scatterv) among the
+leaders. The root then talks to one processor per node instead of one per
+core, and bytes never cross the network between processors of a node.
+The root of the gather and the scatter is rank 0 of the communicator, which
+always leads its node.
+
+Build with: compile collectives.c along with the program using it
+******************************************************************************/
+#ifndef COLLECTIVES_H
+#define COLLECTIVES_H
+
+#include <stdint.h>
+#include "mpi.h"
+
+#define COLL_TOO_BIG -1 //the bytes of all processors do not fit in int counts
+#define COLL_NO_MEMORY -2 //memory ran out
+
+typedef struct coll_param{
+    void* address; //where the parameter is on every processor
+    int count; //number of elements
+    MPI_Datatype type; //type of the elements
+} coll_param;
+
+typedef struct coll_node{
+    MPI_Comm comm; //communicator the layout describes
+    int rank; //rank in comm
+    int size; //number of processors in comm
+    MPI_Comm node; //processors of comm sharing memory with this one
+    int node_rank; //rank in node, 0 leads the node
+    int node_size; //number of processors in node
+    int* members; //ranks in comm of the node's processors, in node order
+    MPI_Comm leaders; //leaders of every node, MPI_COMM_NULL if not leading
+    int num_nodes; //number of nodes, on the root
+    int* node_sizes; //processors of every node, on the root
+    int* node_members; //ranks in comm of every node's processors, node by
+                       //node, on the root
+} coll_node;
+
+int coll_bcast_params(coll_param* params, int count, int root, MPI_Comm comm);
+/**
+ * @param: parameters, their number, rank broadcasting them, communicator
+ *
+ * @brief: broadcasts every parameter with a single MPI_Bcast of a struct
+ * datatype of their absolute addresses
+ *
+ * @return: 0 on success, COLL_NO_MEMORY if the datatype could not be built
+ *
+*/
+
+int coll_node_init(coll_node* layout, MPI_Comm comm);
+/**
+ * @param: layout to fill in, communicator, every processor of it calls
+ *
+ * @brief: splits the communicator into nodes and their leaders, and gives
+ * the root the processors of every node
+ *
+ * @return: 0 on success, COLL_NO_MEMORY if memory ran out
+ *
+*/
+
+int coll_gatherv_bytes(coll_node* layout, const void* send, int64_t length,
+                       unsigned char** gathered, int64_t** lengths,
+                       int64_t** offsets);
+/**
+ * @param: layout, bytes of this processor and their number, where the root
+ *         stores the gathered bytes, every processor's number of bytes and
+ *         where they start in the gathered bytes (indexed by rank)
+ *
+ * @brief: two level gather to the root, through the shared window of every
+ * node and a Gatherv among the leaders. The root frees the three arrays,
+ * they are NULL elsewhere
+ *
+ * @return: 0 on success, COLL_TOO_BIG on every processor when the bytes
+ * of all processors pass INT_MAX, nothing is gathered then, COLL_NO_MEMORY
+ * if memory ran out
+ *
+*/
+
+int coll_scatterv_bytes(coll_node* layout, const void* send,
+                        const int64_t* lengths, const int64_t* offsets,
+                        unsigned char** received, int64_t* length);
+/**
+ * @param: layout, on the root the bytes to scatter, every processor's
+ *         number of bytes and where they start in send (indexed by rank),
+ *         where every processor stores its bytes and their number
+ *
+ * @brief: two level scatter from the root, a Scatterv among the leaders
+ * into the shared window of every node, which every processor of the node
+ * copies its bytes out of. The received bytes are malloc'd
+ *
+ * @return: 0 on success, COLL_TOO_BIG on every processor when the bytes
+ * of all processors pass INT_MAX, COLL_NO_MEMORY if memory ran out
+ *
+*/
+
+void coll_node_free(coll_node* layout);
+/**
+ * @param: layout to release
+ *
+ * @brief: frees the communicators and the arrays of the layout
+ *
+*/
+
+#endif
@@ -0,0 +1,411 @@
+/******************************************************************************
+Title : match.c
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Implementation of the literal matcher described in match.h.
+The short pattern path compares 16 text bytes at a time against the first and
+the last byte of the pattern with SSE2 and only verifies the positions where
+both agree. Machines without SSE2 fall back to memchr on the first byte.
+Ignoring case only changes the prefilter, which ORs 0x20 into the lanes
+compared against a letter, and the Horspool path, so the exact paths keep
+their memcmp verify.
+
+Build with: compile match.c along with the program using it
+******************************************************************************/
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "match.h"
+
+static size_t critical_factorization(const unsigned char* pattern, size_t length,
+                                     size_t* period);
+/**
+ * @param: pattern bytes, length of the pattern, where to store the period
+ *
+ * @brief: computes the critical factorization of the pattern used by two way,
+ * taking the later of the maximal suffixes for both byte orderings
+ *
+ * @return: size_t position splitting the pattern into its left and right half
+ *
+*/
+static size_t scan_memchr(const matcher* m, const unsigned char* text,
+                          size_t starts, match_report report, void* arg);
+static size_t scan_prefilter(const matcher* m, const unsigned char* text,
+                             size_t starts, match_report report, void* arg);
+static size_t scan_horspool(const matcher* m, const unsigned char* text,
+                            size_t starts, match_report report, void* arg);
+static size_t scan_prefilter_fold(const matcher* m, const unsigned char* text,
+                                  size_t starts, match_report report, void* arg);
+static size_t scan_two_way(const matcher* m, const unsigned char* text,
+                           size_t starts, match_report report, void* arg);
+/**
+ * @param: prepared matcher, text, number of starting positions that fit the
+ *         whole pattern, report callback and its argument
+ *
+ * @brief: the scanning loop of each algorithm, starts is already clamped so
+ * no bounds checks against the text length are needed inside
+ *
+ * @return: number of occurences reported
+ *
+*/
+static inline unsigned char fold(unsigned char c);
+/**
+ * @param: byte
+ *
+ * @brief: lower case of an ASCII letter, any other byte unchanged
+ *
+*/
+static int equal_fold(const unsigned char* text, const unsigned char* pattern,
+                      size_t length);
+/**
+ * @param: text, lower case pattern, number of bytes to compare
+ *
+ * @brief: memcmp that ignores the case of ASCII letters in the text
+ *
+ * @return: 1 if the bytes are equal up to case, 0 otherwise
+ *
+*/
+
+int matcher_init(matcher* m, const char* pattern, size_t length){
+    return matcher_init_flags(m, pattern, length, 0);
+}
+
+int matcher_init_flags(matcher* m, const char* pattern, size_t length, int flags){
+    memset(m, 0, sizeof(matcher));
+    if(length == 0){
+        return -1;
+    }
+    m->pattern = (unsigned char *)malloc(length * sizeof(unsigned char));
+    if(m->pattern == NULL){
+        return -1;
+    }
+    memcpy(m->pattern, pattern, length);
+    m->length = length;
+
+    if(flags & MATCH_IGNORE_CASE){
+        m->ignore_case = 1;
+        for(size_t i = 0; i < length; i++){
+            m->pattern[i] = fold(m->pattern[i]);
+        }
+        if(length <= MATCH_SHORT_MAX){
+            m->algorithm = MATCH_PREFILTER;
+        }else{
+            //both cases of a letter get the shift of the letter
+            m->algorithm = MATCH_HORSPOOL;
+            for(int c = 0; c < 256; c++){
+                m->shift[c] = length;
+            }
+            for(size_t i = 0; i < length - 1; i++){
+                m->shift[m->pattern[i]] = length - 1 - i;
+                if(m->pattern[i] >= 'a' && m->pattern[i] <= 'z'){
+                    m->shift[m->pattern[i] - 'a' + 'A'] = length - 1 - i;
+                }
+            }
+        }
+        return 0;
+    }
+    if(length == 1){
+        m->algorithm = MATCH_MEMCHR;
+    }else if(length <= MATCH_SHORT_MAX){
+        m->algorithm = MATCH_PREFILTER;
+    }else if(length <= MATCH_HORSPOOL_MAX){
+        m->algorithm = MATCH_HORSPOOL;
+        //every byte shifts the whole pattern unless it occurs before the last byte
+        for(int c = 0; c < 256; c++){
+            m->shift[c] = length;
+        }
+        for(size_t i = 0; i < length - 1; i++){
+            m->shift[m->pattern[i]] = length - 1 - i;
+        }
+    }else{
+        m->algorithm = MATCH_TWO_WAY;
+        m->critical = critical_factorization(m->pattern, length, &m->period);
+        if(memcmp(m->pattern, m->pattern + m->period, m->critical) == 0){
+            m->periodic = 1;
+        }else{
+            //left half is not a suffix of the period, shift past the larger half
+            size_t right = length - m->critical;
+            m->period = (m->critical > right ? m->critical : right) + 1;
+            m->periodic = 0;
+        }
+    }
+    return 0;
+}
+
+size_t matcher_scan(const matcher* m, const char* text, size_t text_length,
+                    size_t starts, match_report report, void* arg){
+    if(text_length < m->length){
+        return 0;
+    }
+    //clamp to the positions where the whole pattern still fits in the text
+    if(starts > text_length - m->length + 1){
+        starts = text_length - m->length + 1;
+    }
+    if(starts == 0){
+        return 0;
+    }
+    const unsigned char* t = (const unsigned char *)text;
+    switch(m->algorithm){
+        case MATCH_MEMCHR:
+            return scan_memchr(m, t, starts, report, arg);
+        case MATCH_PREFILTER:
+            if(m->ignore_case){
+                return scan_prefilter_fold(m, t, starts, report, arg);
+            }
+            return scan_prefilter(m, t, starts, report, arg);
+        case MATCH_HORSPOOL:
+            return scan_horspool(m, t, starts, report, arg);
+        default:
+            return scan_two_way(m, t, starts, report, arg);
+    }
+}
+
+void matcher_free(matcher* m){
+    free(m->pattern);
+    m->pattern = NULL;
+    m->length = 0;
+}
+
+static size_t critical_factorization(const unsigned char* pattern, size_t length,
+                                     size_t* period){
+    size_t max_suffix, max_suffix_rev; //start of the maximal suffixes - 1
+    size_t j, k, p; //candidate position, offset in the comparison, period
+
+    //maximal suffix for the normal byte order
+    max_suffix = SIZE_MAX;
+    j = 0;
+    k = p = 1;
+    while(j + k < length){
+        unsigned char a = pattern[j + k];
+        unsigned char b = pattern[max_suffix + k];
+        if(a < b){
+            j += k;
+            k = 1;
+            p = j - max_suffix;
+        }else if(a == b){
+            if(k != p){
+                k++;
+            }else{
+                j += p;
+                k = 1;
+            }
+        }else{
+            max_suffix = j++;
+            k = p = 1;
+        }
+    }
+    *period = p;
+
+    //maximal suffix for the reversed byte order
+    max_suffix_rev = SIZE_MAX;
+    j = 0;
+    k = p = 1;
+    while(j + k < length){
+        unsigned char a = pattern[j + k];
+        unsigned char b = pattern[max_suffix_rev + k];
+        if(b < a){
+            j += k;
+            k = 1;
+            p = j - max_suffix_rev;
+        }else if(a == b){
+            if(k != p){
+                k++;
+            }else{
+                j += p;
+                k = 1;
+            }
+        }else{
+            max_suffix_rev = j++;
+            k = p = 1;
+        }
+    }
+    //the later of the two suffixes gives the critical factorization
+    if(max_suffix_rev + 1 < max_suffix + 1){
+        return max_suffix + 1;
+    }
+    *period = p;
+    return max_suffix_rev + 1;
+}
+
+static size_t scan_memchr(const matcher* m, const unsigned char* text,
+                          size_t starts, match_report report, void* arg){
+    size_t found = 0; //number of occurences
+    const unsigned char* cur = text;
+    const unsigned char* end = text + starts;
+    while(cur < end && (cur = memchr(cur, m->pattern[0], end - cur)) != NULL){
+        report(cur - text, arg);
+        found++;
+        cur++;
+    }
+    return found;
+}
+
+static size_t scan_prefilter(const matcher* m, const unsigned char* text,
+                             size_t starts, match_report report, void* arg){
+    size_t found = 0; //number of occurences
+    size_t last = m->length - 1; //offset of the last pattern byte
+    unsigned char first_byte = m->pattern[0];
+    unsigned char last_byte = m->pattern[last];
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i first_vec = _mm_set1_epi8((char)first_byte);
+    const __m128i last_vec = _mm_set1_epi8((char)last_byte);
+    //a block of 16 starts reads up to text[i + 15 + last], which is in bounds
+    for(; i + 16 <= starts; i += 16){
+        __m128i head = _mm_loadu_si128((const __m128i *)(text + i));
+        __m128i tail = _mm_loadu_si128((const __m128i *)(text + i + last));
+        unsigned int mask = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(head, first_vec),
+                          _mm_cmpeq_epi8(tail, last_vec)));
+        while(mask != 0){
+            unsigned int bit = __builtin_ctz(mask);
+            if(memcmp(text + i + bit + 1, m->pattern + 1, m->length - 2) == 0){
+                report(i + bit, arg);
+                found++;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    //remaining starts (all of them without SSE2) jump between first bytes
+    while(i < starts){
+        const unsigned char* cur = memchr(text + i, first_byte, starts - i);
+        if(cur == NULL){
+            break;
+        }
+        i = cur - text;
+        if(text[i + last] == last_byte &&
+           memcmp(text + i + 1, m->pattern + 1, m->length - 2) == 0){
+            report(i, arg);
+            found++;
+        }
+        i++;
+    }
+    return found;
+}
+
+static size_t scan_horspool(const matcher* m, const unsigned char* text,
+                            size_t starts, match_report report, void* arg){
+    size_t found = 0; //number of occurences
+    size_t last = m->length - 1; //offset of the last pattern byte
+    unsigned char last_byte = m->pattern[last];
+    size_t pos = 0;
+    if(m->ignore_case){
+        while(pos < starts){
+            unsigned char c = text[pos + last];
+            if(fold(c) == last_byte && equal_fold(text + pos, m->pattern, last)){
+                report(pos, arg);
+                found++;
+            }
+            pos += m->shift[c];
+        }
+        return found;
+    }
+    while(pos < starts){
+        unsigned char c = text[pos + last];
+        if(c == last_byte && memcmp(text + pos, m->pattern, last) == 0){
+            report(pos, arg);
+            found++;
+        }
+        pos += m->shift[c];
+    }
+    return found;
+}
+
+static size_t scan_prefilter_fold(const matcher* m, const unsigned char* text,
+                                  size_t starts, match_report report, void* arg){
+    size_t found = 0; //number of occurences
+    size_t last = m->length - 1; //offset of the last pattern byte
+    unsigned char first_byte = m->pattern[0];
+    unsigned char last_byte = m->pattern[last];
+    size_t i = 0;
+#ifdef __SSE2__
+    //x | 0x20 equals a lower case letter only for that letter in either case
+    const __m128i first_vec = _mm_set1_epi8((char)first_byte);
+    const __m128i last_vec = _mm_set1_epi8((char)last_byte);
+    const __m128i first_fold = _mm_set1_epi8((first_byte >= 'a' && first_byte <= 'z') ? 0x20 : 0);
+    const __m128i last_fold = _mm_set1_epi8((last_byte >= 'a' && last_byte <= 'z') ? 0x20 : 0);
+    for(; i + 16 <= starts; i += 16){
+        __m128i head = _mm_loadu_si128((const __m128i *)(text + i));
+        __m128i tail = _mm_loadu_si128((const __m128i *)(text + i + last));
+        unsigned int mask = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(_mm_or_si128(head, first_fold), first_vec),
+                          _mm_cmpeq_epi8(_mm_or_si128(tail, last_fold), last_vec)));
+        while(mask != 0){
+            unsigned int bit = __builtin_ctz(mask);
+            if(last < 2 || equal_fold(text + i + bit + 1, m->pattern + 1, last - 1)){
+                report(i + bit, arg);
+                found++;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    //remaining starts (all of them without SSE2)
+    for(; i < starts; i++){
+        if(fold(text[i]) == first_byte && fold(text[i + last]) == last_byte &&
+           (last < 2 || equal_fold(text + i + 1, m->pattern + 1, last - 1))){
+            report(i, arg);
+            found++;
+        }
+    }
+    return found;
+}
+
+static inline unsigned char fold(unsigned char c){
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+static int equal_fold(const unsigned char* text, const unsigned char* pattern,
+                      size_t length){
+    for(size_t k = 0; k < length; k++){
+        if(fold(text[k]) != pattern[k]){
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static size_t scan_two_way(const matcher* m, const unsigned char* text,
+                           size_t starts, match_report report, void* arg){
+    size_t found = 0; //number of occurences
+    const unsigned char* pattern = m->pattern;
+    size_t length = m->length;
+    size_t critical = m->critical;
+    size_t period = m->period;
+    size_t memory = 0; //prefix of the window known to match from the last shift
+    size_t i;
+    size_t j = 0; //current window position
+
+    while(j < starts){
+        //match the right half left to right
+        i = (critical > memory) ? critical : memory;
+        while(i < length && pattern[i] == text[i + j]){
+            i++;
+        }
+        if(i < length){
+            //mismatch in the right half, skip past it
+            j += i - critical + 1;
+            memory = 0;
+            continue;
+        }
+        //match the left half right to left, stopping at the remembered prefix
+        i = critical;
+        while(i > memory && pattern[i - 1] == text[i - 1 + j]){
+            i--;
+        }
+        if(i <= memory){
+            report(j, arg);
+            found++;
+        }
+        j += period;
+        if(m->periodic){
+            memory = length - period;
+        }
+    }
+    return found;
+}
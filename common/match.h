@@ -0,0 +1,104 @@
+/******************************************************************************
+Title : match.h
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Literal pattern matcher shared by search and redact. A matcher is
+prepared once for a pattern and then scans any number of buffers. The algorithm
+is picked from the pattern length: a single byte uses memchr, short patterns
+use a SIMD first byte / last byte prefilter with a memcmp verify, medium
+patterns use Boyer-Moore-Horspool and long patterns use the Two-Way algorithm
+of Crochemore and Perrin so the worst case stays linear in the text length.
+Every occurence is reported, overlapping ones included, and the text is
+handled by length so embedded NUL bytes do not end the scan.
+
+With MATCH_IGNORE_CASE ASCII letters match regardless of case. The pattern
+is stored in lower case, the prefilter folds 16 text bytes at a time by
+setting bit 0x20 of the lanes compared against a letter, which is exact for
+letters, and candidates are verified through a fold of each byte. Patterns
+past MATCH_SHORT_MAX use Horspool with both cases in the shift table.
+
+Build with: compile match.c along with the program using it
+******************************************************************************/
+#ifndef MATCH_H
+#define MATCH_H
+
+#include <stddef.h>
+
+#define MATCH_SHORT_MAX 16 //longest pattern handled by the prefilter
+#define MATCH_HORSPOOL_MAX 64 //longest pattern handled by horspool
+#define MATCH_IGNORE_CASE 1 //flag of matcher_init_flags, ASCII letters match either case
+
+typedef enum match_algorithm{
+    MATCH_MEMCHR,
+    MATCH_PREFILTER,
+    MATCH_HORSPOOL,
+    MATCH_TWO_WAY
+} match_algorithm;
+
+typedef struct matcher{
+    unsigned char* pattern; //private copy of the pattern
+    size_t length; //length of the pattern
+    match_algorithm algorithm; //algorithm picked from the length
+    size_t shift[256]; //horspool bad character shifts
+    size_t critical; //two way critical factorization position
+    size_t period; //two way shift after the right half matched
+    int periodic; //two way: pattern is periodic so memory can be used
+    int ignore_case; //1 when letters match regardless of case
+} matcher;
+
+typedef void (*match_report)(size_t position, void* arg);
+/**
+ * @param: size_t position of the occurence in the scanned text,
+ *         void pointer handed to matcher_scan
+ *
+ * @brief: called once for every occurence, in increasing position order
+ *
+*/
+
+int matcher_init(matcher* m, const char* pattern, size_t length);
+/**
+ * @param: matcher to prepare, pattern bytes, length of the pattern
+ *
+ * @brief: copies the pattern, picks the algorithm from its length and
+ * builds the tables that algorithm needs
+ *
+ * @return: 0 on success, -1 if the pattern is empty or memory ran out
+ *
+*/
+
+int matcher_init_flags(matcher* m, const char* pattern, size_t length, int flags);
+/**
+ * @param: matcher to prepare, pattern bytes, length of the pattern, 0 or
+ *         MATCH_IGNORE_CASE
+ *
+ * @brief: same as matcher_init, matcher_init is matcher_init_flags with 0
+ *
+ * @return: 0 on success, -1 if the pattern is empty or memory ran out
+ *
+*/
+
+size_t matcher_scan(const matcher* m, const char* text, size_t text_length,
+                    size_t starts, match_report report, void* arg);
+/**
+ * @param: prepared matcher, text to scan, length of the text, number of
+ *         starting positions to check, report callback and its argument
+ *
+ * @brief: reports every position p < starts where the whole pattern fits
+ * inside the text and occurs at text[p]. Callers that split a text among
+ * workers pass their own share as starts and hand in pattern length - 1
+ * extra bytes so occurences crossing the split are still seen once
+ *
+ * @return: number of occurences reported
+ *
+*/
+
+void matcher_free(matcher* m);
+/**
+ * @param: matcher to release
+ *
+ * @brief: frees the private copy of the pattern
+ *
+*/
+
+#endif
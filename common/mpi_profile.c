@@ -0,0 +1,519 @@
+/******************************************************************************
+Title : mpi_profile.c
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Implementation of the PMPI profiler described in
+mpi_profile.h. Every wrapper reads the clock before and after the PMPI_
+call and adds to the numbers of its call. Only the main thread of the
+programs calls MPI, so the numbers need no lock. The trace is kept in memory
+and written at MPI_Finalize, files are never touched while the program runs.
+
+Build with: compile mpi_profile.c along with the program using it
+******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mpi.h"
+#include "mpi_profile.h"
+
+#define PROFILE_ROOT 0
+#define PROFILE_VALUES 4 //numbers kept per call: calls, bytes, time, wait
+
+static const char* call_names[PROFILE_CALLS] = {
+    "MPI_Send", "MPI_Recv", "MPI_Bcast", "MPI_Reduce", "MPI_Allreduce",
+    "MPI_Barrier", "MPI_Gather", "MPI_Gatherv", "MPI_Scatterv",
+    "MPI_Allgather", "MPI_Allgatherv", "MPI_Exscan", "MPI_Wait",
+    "MPI_File_open", "MPI_File_close", "MPI_File_set_size",
+    "MPI_File_read_at", "MPI_File_read_at_all", "MPI_File_iread_at",
+    "MPI_File_write_at", "MPI_File_write_at_all", "MPI_Sendrecv",
+    "MPI_Scatter", "MPI_Win_sync", "MPI_File_iwrite_at",
+    "MPI_Win_allocate_shared", "MPI_Win_free", "MPI_Comm_split",
+    "MPI_Comm_split_type"
+};
+
+static double numbers[PROFILE_CALLS][PROFILE_VALUES]; //this processor's numbers
+static double init_time; //when MPI_Init returned
+static int wait_before_collectives; //MPI_PROFILE_WAIT is set
+static profile_event* trace; //calls of this processor, NULL without a trace
+static int64_t trace_count; //calls seen since MPI_Init, kept or not
+
+static void profile_init(void);
+/**
+ * @brief: starts the clock and reads the environment once MPI is up
+ *
+*/
+static double profile_start(MPI_Comm comm, double* wait);
+/**
+ * @param: communicator of a collective call (MPI_COMM_NULL otherwise),
+ *         where to store the wait, NULL for a call that is all wait
+ *
+ * @brief: times the barrier before a collective call when asked to
+ *
+ * @return: time the call itself starts at
+ *
+*/
+static void profile_stop(int call, double start, double wait, int64_t bytes,
+                         int peer);
+/**
+ * @param: PROFILE_ id of the call, time it started at, time waited before
+ *         it, bytes it moved for this processor, destination, source or root
+ *
+ * @brief: adds the call to its numbers and to the trace
+ *
+*/
+static int64_t type_bytes(int64_t count, MPI_Datatype datatype);
+/**
+ * @param: number of elements, their datatype
+ *
+ * @return: int64_t number of bytes of the elements
+ *
+*/
+static void print_summary(double* all, int p);
+/**
+ * @param: numbers of every processor one after the other, number of
+ *         processors
+ *
+ * @brief: prints the table of every call that was made and of compute
+ *
+*/
+static void write_trace(int id);
+/**
+ * @param: rank of this processor
+ *
+ * @brief: writes the kept events to <MPI_PROFILE_TRACE>.<rank>
+ *
+*/
+
+int MPI_Init(int* argc, char*** argv){
+    int result = PMPI_Init(argc, argv);
+    profile_init();
+    return result;
+}
+
+int MPI_Init_thread(int* argc, char*** argv, int required, int* provided){
+    int result = PMPI_Init_thread(argc, argv, required, provided);
+    profile_init();
+    return result;
+}
+
+int MPI_Finalize(void){
+    double elapsed = PMPI_Wtime() - init_time;
+    int id, p;
+    PMPI_Comm_rank(MPI_COMM_WORLD, &id);
+    PMPI_Comm_size(MPI_COMM_WORLD, &p);
+
+    //every processor sends its numbers, then compute and total time
+    int per_rank = PROFILE_CALLS * PROFILE_VALUES + 2;
+    double mine[per_rank];
+    double in_mpi = 0;
+    for(int c = 0; c < PROFILE_CALLS; c++){
+        memcpy(&mine[c * PROFILE_VALUES], numbers[c], sizeof(numbers[c]));
+        in_mpi += numbers[c][2] + numbers[c][3];
+    }
+    mine[per_rank - 2] = elapsed - in_mpi;
+    mine[per_rank - 1] = elapsed;
+    double* all = NULL;
+    if(id == PROFILE_ROOT){
+        all = (double *)malloc(p * per_rank * sizeof(double));
+    }
+    PMPI_Gather(mine, per_rank, MPI_DOUBLE, all, per_rank, MPI_DOUBLE,
+                PROFILE_ROOT, MPI_COMM_WORLD);
+    if(id == PROFILE_ROOT && all != NULL){
+        print_summary(all, p);
+        free(all);
+    }
+    if(trace != NULL){
+        write_trace(id);
+        free(trace);
+        trace = NULL;
+    }
+    return PMPI_Finalize();
+}
+
+int MPI_Send(const void* buf, int count, MPI_Datatype datatype, int dest,
+             int tag, MPI_Comm comm){
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_Send(buf, count, datatype, dest, tag, comm);
+    profile_stop(PROFILE_SEND, start, wait, type_bytes(count, datatype), dest);
+    return result;
+}
+
+int MPI_Recv(void* buf, int count, MPI_Datatype datatype, int source, int tag,
+             MPI_Comm comm, MPI_Status* status){
+    MPI_Status own; //status to count the bytes when the caller ignores it
+    if(status == MPI_STATUS_IGNORE){
+        status = &own;
+    }
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_Recv(buf, count, datatype, source, tag, comm, status);
+    int received = count;
+    PMPI_Get_count(status, datatype, &received);
+    profile_stop(PROFILE_RECV, start, wait, type_bytes(received, datatype),
+                 status->MPI_SOURCE);
+    return result;
+}
+
+int MPI_Sendrecv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                 int dest, int sendtag, void* recvbuf, int recvcount,
+                 MPI_Datatype recvtype, int source, int recvtag, MPI_Comm comm,
+                 MPI_Status* status){
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_Sendrecv(sendbuf, sendcount, sendtype, dest, sendtag,
+                               recvbuf, recvcount, recvtype, source, recvtag,
+                               comm, status);
+    //counted as the bytes sent, a halo exchange receives as many
+    profile_stop(PROFILE_SENDRECV, start, wait, type_bytes(sendcount, sendtype), dest);
+    return result;
+}
+
+int MPI_Bcast(void* buffer, int count, MPI_Datatype datatype, int root,
+              MPI_Comm comm){
+    double wait;
+    double start = profile_start(comm, &wait);
+    int result = PMPI_Bcast(buffer, count, datatype, root, comm);
+    profile_stop(PROFILE_BCAST, start, wait, type_bytes(count, datatype), root);
+    return result;
+}
+
+int MPI_Reduce(const void* sendbuf, void* recvbuf, int count,
+               MPI_Datatype datatype, MPI_Op op, int root, MPI_Comm comm){
+    double wait;
+    double start = profile_start(comm, &wait);
+    int result = PMPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+    profile_stop(PROFILE_REDUCE, start, wait, type_bytes(count, datatype), root);
+    return result;
+}
+
+int MPI_Allreduce(const void* sendbuf, void* recvbuf, int count,
+                  MPI_Datatype datatype, MPI_Op op, MPI_Comm comm){
+    double wait;
+    double start = profile_start(comm, &wait);
+    int result = PMPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+    profile_stop(PROFILE_ALLREDUCE, start, wait, type_bytes(count, datatype), -1);
+    return result;
+}
+
+int MPI_Barrier(MPI_Comm comm){
+    //a barrier is all wait, there is nothing to time before it
+    double start = profile_start(MPI_COMM_NULL, NULL);
+    int result = PMPI_Barrier(comm);
+    profile_stop(PROFILE_BARRIER, start, 0, 0, -1);
+    return result;
+}
+
+int MPI_Gather(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+               void* recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+               MPI_Comm comm){
+    double wait;
+    double start = profile_start(comm, &wait);
+    int result = PMPI_Gather(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+                             recvtype, root, comm);
+    profile_stop(PROFILE_GATHER, start, wait, type_bytes(sendcount, sendtype), root);
+    return result;
+}
+
+int MPI_Gatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                void* recvbuf, const int recvcounts[], const int displs[],
+                MPI_Datatype recvtype, int root, MPI_Comm comm){
+    double wait;
+    double start = profile_start(comm, &wait);
+    int result = PMPI_Gatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts,
+                              displs, recvtype, root, comm);
+    profile_stop(PROFILE_GATHERV, start, wait, type_bytes(sendcount, sendtype), root);
+    return result;
+}
+
+int MPI_Scatter(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                void* recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+                MPI_Comm comm){
+    double wait;
+    double start = profile_start(comm, &wait);
+    int result = PMPI_Scatter(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+                              recvtype, root, comm);
+    profile_stop(PROFILE_SCATTER, start, wait, type_bytes(recvcount, recvtype), root);
+    return result;
+}
+
+int MPI_Scatterv(const void* sendbuf, const int sendcounts[], const int displs[],
+                 MPI_Datatype sendtype, void* recvbuf, int recvcount,
+                 MPI_Datatype recvtype, int root, MPI_Comm comm){
+    double wait;
+    double start = profile_start(comm, &wait);
+    int result = PMPI_Scatterv(sendbuf, sendcounts, displs, sendtype, recvbuf,
+                               recvcount, recvtype, root, comm);
+    profile_stop(PROFILE_SCATTERV, start, wait, type_bytes(recvcount, recvtype), root);
+    return result;
+}
+
+int MPI_Allgather(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                  void* recvbuf, int recvcount, MPI_Datatype recvtype,
+                  MPI_Comm comm){
+    double wait;
+    double start = profile_start(comm, &wait);
+    int result = PMPI_Allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+                                recvtype, comm);
+    profile_stop(PROFILE_ALLGATHER, start, wait, type_bytes(sendcount, sendtype), -1);
+    return result;
+}
+
+int MPI_Allgatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+                   void* recvbuf, const int recvcounts[], const int displs[],
+                   MPI_Datatype recvtype, MPI_Comm comm){
+    double wait;
+    double start = profile_start(comm, &wait);
+    int result = PMPI_Allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts,
+                                 displs, recvtype, comm);
+    profile_stop(PROFILE_ALLGATHERV, start, wait, type_bytes(sendcount, sendtype), -1);
+    return result;
+}
+
+int MPI_Exscan(const void* sendbuf, void* recvbuf, int count,
+               MPI_Datatype datatype, MPI_Op op, MPI_Comm comm){
+    double wait;
+    double start = profile_start(comm, &wait);
+    int result = PMPI_Exscan(sendbuf, recvbuf, count, datatype, op, comm);
+    profile_stop(PROFILE_EXSCAN, start, wait, type_bytes(count, datatype), -1);
+    return result;
+}
+
+int MPI_Comm_split(MPI_Comm comm, int color, int key, MPI_Comm* newcomm){
+    double wait;
+    double start = profile_start(comm, &wait);
+    int result = PMPI_Comm_split(comm, color, key, newcomm);
+    profile_stop(PROFILE_COMM_SPLIT, start, wait, 0, -1);
+    return result;
+}
+
+int MPI_Comm_split_type(MPI_Comm comm, int split_type, int key, MPI_Info info,
+                        MPI_Comm* newcomm){
+    double wait;
+    double start = profile_start(comm, &wait);
+    int result = PMPI_Comm_split_type(comm, split_type, key, info, newcomm);
+    profile_stop(PROFILE_COMM_SPLIT_TYPE, start, wait, 0, -1);
+    return result;
+}
+
+int MPI_Wait(MPI_Request* request, MPI_Status* status){
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_Wait(request, status);
+    profile_stop(PROFILE_WAIT, start, wait, 0, -1);
+    return result;
+}
+
+int MPI_Win_allocate_shared(MPI_Aint size, int disp_unit, MPI_Info info,
+                            MPI_Comm comm, void* baseptr, MPI_Win* win){
+    double wait;
+    double start = profile_start(comm, &wait);
+    int result = PMPI_Win_allocate_shared(size, disp_unit, info, comm, baseptr, win);
+    profile_stop(PROFILE_WIN_ALLOCATE_SHARED, start, wait, size, -1);
+    return result;
+}
+
+int MPI_Win_free(MPI_Win* win){
+    //collective over the window's processors, which the call does not name
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_Win_free(win);
+    profile_stop(PROFILE_WIN_FREE, start, wait, 0, -1);
+    return result;
+}
+
+int MPI_Win_sync(MPI_Win win){
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_Win_sync(win);
+    profile_stop(PROFILE_WIN_SYNC, start, wait, 0, -1);
+    return result;
+}
+
+int MPI_File_open(MPI_Comm comm, const char* filename, int amode,
+                  MPI_Info info, MPI_File* fh){
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_File_open(comm, filename, amode, info, fh);
+    profile_stop(PROFILE_FILE_OPEN, start, wait, 0, -1);
+    return result;
+}
+
+int MPI_File_close(MPI_File* fh){
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_File_close(fh);
+    profile_stop(PROFILE_FILE_CLOSE, start, wait, 0, -1);
+    return result;
+}
+
+int MPI_File_set_size(MPI_File fh, MPI_Offset size){
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_File_set_size(fh, size);
+    profile_stop(PROFILE_FILE_SET_SIZE, start, wait, 0, -1);
+    return result;
+}
+
+int MPI_File_read_at(MPI_File fh, MPI_Offset offset, void* buf, int count,
+                     MPI_Datatype datatype, MPI_Status* status){
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_File_read_at(fh, offset, buf, count, datatype, status);
+    profile_stop(PROFILE_FILE_READ_AT, start, wait, type_bytes(count, datatype), -1);
+    return result;
+}
+
+int MPI_File_read_at_all(MPI_File fh, MPI_Offset offset, void* buf, int count,
+                         MPI_Datatype datatype, MPI_Status* status){
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_File_read_at_all(fh, offset, buf, count, datatype, status);
+    profile_stop(PROFILE_FILE_READ_AT_ALL, start, wait, type_bytes(count, datatype), -1);
+    return result;
+}
+
+int MPI_File_iread_at(MPI_File fh, MPI_Offset offset, void* buf, int count,
+                      MPI_Datatype datatype, MPI_Request* request){
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_File_iread_at(fh, offset, buf, count, datatype, request);
+    profile_stop(PROFILE_FILE_IREAD_AT, start, wait, type_bytes(count, datatype), -1);
+    return result;
+}
+
+int MPI_File_write_at(MPI_File fh, MPI_Offset offset, const void* buf, int count,
+                      MPI_Datatype datatype, MPI_Status* status){
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_File_write_at(fh, offset, buf, count, datatype, status);
+    profile_stop(PROFILE_FILE_WRITE_AT, start, wait, type_bytes(count, datatype), -1);
+    return result;
+}
+
+int MPI_File_write_at_all(MPI_File fh, MPI_Offset offset, const void* buf,
+                          int count, MPI_Datatype datatype, MPI_Status* status){
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_File_write_at_all(fh, offset, buf, count, datatype, status);
+    profile_stop(PROFILE_FILE_WRITE_AT_ALL, start, wait, type_bytes(count, datatype), -1);
+    return result;
+}
+
+int MPI_File_iwrite_at(MPI_File fh, MPI_Offset offset, const void* buf,
+                       int count, MPI_Datatype datatype, MPI_Request* request){
+    double wait;
+    double start = profile_start(MPI_COMM_NULL, &wait);
+    int result = PMPI_File_iwrite_at(fh, offset, buf, count, datatype, request);
+    profile_stop(PROFILE_FILE_IWRITE_AT, start, wait, type_bytes(count, datatype), -1);
+    return result;
+}
+
+static void profile_init(void){
+    memset(numbers, 0, sizeof(numbers));
+    trace_count = 0;
+    char* setting = getenv("MPI_PROFILE_WAIT");
+    wait_before_collectives = (setting != NULL && strcmp(setting, "0") != 0);
+    if(getenv("MPI_PROFILE_TRACE") != NULL){
+        trace = (profile_event *)malloc(PROFILE_TRACE_MAX * sizeof(profile_event));
+    }
+    init_time = PMPI_Wtime();
+}
+
+static double profile_start(MPI_Comm comm, double* wait){
+    double now = PMPI_Wtime();
+    if(wait == NULL){
+        return now;
+    }
+    *wait = 0;
+    if(wait_before_collectives && comm != MPI_COMM_NULL){
+        PMPI_Barrier(comm);
+        double arrived = PMPI_Wtime();
+        *wait = arrived - now;
+        now = arrived;
+    }
+    return now;
+}
+
+static void profile_stop(int call, double start, double wait, int64_t bytes,
+                         int peer){
+    double duration = PMPI_Wtime() - start;
+    numbers[call][0] += 1;
+    numbers[call][1] += bytes;
+    numbers[call][2] += duration;
+    numbers[call][3] += wait;
+    if(trace != NULL && trace_count < PROFILE_TRACE_MAX){
+        profile_event* event = &trace[trace_count];
+        event->call = call;
+        event->peer = peer;
+        event->bytes = bytes;
+        event->start = start - wait - init_time;
+        event->wait = wait;
+        event->duration = duration;
+    }
+    trace_count++;
+}
+
+static int64_t type_bytes(int64_t count, MPI_Datatype datatype){
+    MPI_Count size = 0;
+    PMPI_Type_size_x(datatype, &size);
+    return count * size;
+}
+
+static void print_summary(double* all, int p){
+    int per_rank = PROFILE_CALLS * PROFILE_VALUES + 2;
+    fprintf(stderr, "MPI profile of %d processors, times in seconds "
+                    "(min / avg / max over processors)\n", p);
+    fprintf(stderr, "%-22s %10s %14s %10s %10s %10s %10s %10s\n", "call", "calls",
+            "bytes", "min", "avg", "max", "wait avg", "wait max");
+    for(int c = 0; c < PROFILE_CALLS; c++){
+        double calls = 0, bytes = 0, wait_sum = 0, wait_max = 0;
+        double low = 0, sum = 0, high = 0;
+        for(int r = 0; r < p; r++){
+            double* mine = &all[r * per_rank + c * PROFILE_VALUES];
+            calls += mine[0];
+            bytes += mine[1];
+            low = (r == 0 || mine[2] < low) ? mine[2] : low;
+            high = (mine[2] > high) ? mine[2] : high;
+            sum += mine[2];
+            wait_sum += mine[3];
+            wait_max = (mine[3] > wait_max) ? mine[3] : wait_max;
+        }
+        if(calls == 0){
+            continue;
+        }
+        fprintf(stderr, "%-22s %10.0f %14.0f %10.6f %10.6f %10.6f %10.6f %10.6f\n",
+                call_names[c], calls, bytes, low, sum / p, high, wait_sum / p, wait_max);
+    }
+    //compute, then the total time, with how far the slowest is above the average
+    const char* rows[2] = {"compute", "total"};
+    for(int k = 0; k < 2; k++){
+        double low = 0, sum = 0, high = 0;
+        for(int r = 0; r < p; r++){
+            double value = all[r * per_rank + PROFILE_CALLS * PROFILE_VALUES + k];
+            low = (r == 0 || value < low) ? value : low;
+            high = (value > high) ? value : high;
+            sum += value;
+        }
+        fprintf(stderr, "%-22s %10s %14s %10.6f %10.6f %10.6f  imbalance %.2f\n",
+                rows[k], "", "", low, sum / p, high, (sum > 0) ? high * p / sum : 1.0);
+    }
+}
+
+static void write_trace(int id){
+    char* prefix = getenv("MPI_PROFILE_TRACE");
+    char name[strlen(prefix) + 16];
+    sprintf(name, "%s.%d", prefix, id);
+    FILE* file = fopen(name, "wb");
+    int64_t kept = (trace_count < PROFILE_TRACE_MAX) ? trace_count : PROFILE_TRACE_MAX;
+    if(file == NULL || fwrite(trace, sizeof(profile_event), kept, file) != kept){
+        fprintf(stderr, "Failed to write the trace file %s!\n", name);
+    }else if(kept < trace_count){
+        fprintf(stderr, "Trace %s kept the first %lld of %lld calls\n", name,
+                (long long)kept, (long long)trace_count);
+    }
+    if(file != NULL){
+        fclose(file);
+    }
+}
@@ -0,0 +1,76 @@
+/******************************************************************************
+Title : mpi_profile.h
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Profiler of the MPI programs through the PMPI interface. The
+profiler defines the MPI calls the programs use itself, each one times the
+matching PMPI_ call of the library and counts its calls and bytes, so a
+program is profiled by linking the profiler in, without changing a line of
+it. Time between MPI_Init and MPI_Finalize that is not spent in a profiled
+call is compute time. At MPI_Finalize the root gathers every processor's
+numbers and prints a table on stderr with the time of every call and of
+compute as minimum, average and maximum over the processors, the ratio of
+the maximum to the average showing how imbalanced they are.
+
+Environment:
+MPI_PROFILE_WAIT=1 times a PMPI_Barrier before every collective call as
+wait, the time a processor spends there is how late the slowest processor
+arrived, the call itself then only counts the transfer. This synchronizes
+the processors more than the program does, so it is off by default.
+MPI_PROFILE_TRACE=<prefix> writes every processor's calls, up to
+PROFILE_TRACE_MAX of them, to <prefix>.<rank> as profile_event records.
+
+Build with: compile mpi_profile.c along with the program using it, or as a
+shared library for LD_PRELOAD:
+mpicc -O2 -shared -fPIC -o libmpi_profile.so mpi_profile.c
+******************************************************************************/
+#ifndef MPI_PROFILE_H
+#define MPI_PROFILE_H
+
+#include <stdint.h>
+
+#define PROFILE_TRACE_MAX (1 << 20) //most events kept in a processor's trace
+
+//profiled calls, index of a call's numbers and id in the trace
+#define PROFILE_SEND 0
+#define PROFILE_RECV 1
+#define PROFILE_BCAST 2
+#define PROFILE_REDUCE 3
+#define PROFILE_ALLREDUCE 4
+#define PROFILE_BARRIER 5
+#define PROFILE_GATHER 6
+#define PROFILE_GATHERV 7
+#define PROFILE_SCATTERV 8
+#define PROFILE_ALLGATHER 9
+#define PROFILE_ALLGATHERV 10
+#define PROFILE_EXSCAN 11
+#define PROFILE_WAIT 12
+#define PROFILE_FILE_OPEN 13
+#define PROFILE_FILE_CLOSE 14
+#define PROFILE_FILE_SET_SIZE 15
+#define PROFILE_FILE_READ_AT 16
+#define PROFILE_FILE_READ_AT_ALL 17
+#define PROFILE_FILE_IREAD_AT 18
+#define PROFILE_FILE_WRITE_AT 19
+#define PROFILE_FILE_WRITE_AT_ALL 20
+#define PROFILE_SENDRECV 21
+#define PROFILE_SCATTER 22
+#define PROFILE_WIN_SYNC 23
+#define PROFILE_FILE_IWRITE_AT 24
+#define PROFILE_WIN_ALLOCATE_SHARED 25
+#define PROFILE_WIN_FREE 26
+#define PROFILE_COMM_SPLIT 27
+#define PROFILE_COMM_SPLIT_TYPE 28
+#define PROFILE_CALLS 29 //number of profiled calls
+
+typedef struct profile_event{
+    int32_t call; //PROFILE_ id of the call
+    int32_t peer; //destination, source or root, -1 when there is none
+    int64_t bytes; //bytes sent, received, read or written by this processor
+    double start; //seconds since MPI_Init when the call started
+    double wait; //seconds in the barrier before it with MPI_PROFILE_WAIT
+    double duration; //seconds in the call itself
+} profile_event;
+
+#endif
@@ -0,0 +1,343 @@
+/******************************************************************************
+Title : ngram_index.c
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Implementation of the trigram index described in
+ngram_index.h. A partition is built with a counting sort: one pass counts
+every trigram in a table of 2^24 counters, a second pass drops each position
+into the bucket of its trigram, and the buckets are encoded in trigram order.
+
+Build with: compile ngram_index.c and varint.c along with the program using it
+******************************************************************************/
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "ngram_index.h"
+#include "varint.h"
+
+#define NGRAM_KEYS (1 << 24) //number of different trigrams
+#define NGRAM_FEW 64 //candidates left when intersecting stops paying off
+
+static int64_t positions_between(const ngram_index* index, uint32_t trigram,
+                                 int64_t begin, int64_t end, int64_t** positions,
+                                 int64_t* capacity);
+/**
+ * @param: opened index, trigram, first and last (excluded) position to keep,
+ *         growable array of positions and its capacity
+ *
+ * @brief: decodes the positions of the trigram in every partition whose
+ * slice meets [begin, end), partitions are in file order so the positions
+ * come out sorted
+ *
+ * @return: int64_t number of positions stored, -1 if the index is corrupted
+ * or memory ran out
+ *
+*/
+static const ngram_entry* find_entry(const ngram_index* index, int64_t partition,
+                                     uint32_t trigram);
+/**
+ * @param: opened index, partition, trigram
+ *
+ * @brief: binary search of the trigram among the entries of the partition
+ *
+ * @return: the entry, NULL if the trigram is not in the slice
+ *
+*/
+
+int ngram_build(const char* slice, int64_t slice_length, int64_t owned,
+                char** block, int64_t* block_size){
+    const unsigned char* s = (const unsigned char *)slice;
+    //positions whose trigram fits in the slice
+    int64_t n = slice_length - (NGRAM_LENGTH - 1);
+    if(n > owned){
+        n = owned;
+    }
+    if(n < 0){
+        n = 0;
+    }
+    if(n > UINT32_MAX){
+        return -1;
+    }
+    uint32_t* bucket_end = (uint32_t *)calloc(NGRAM_KEYS, sizeof(uint32_t));
+    uint32_t* positions = (uint32_t *)malloc((n + 1) * sizeof(uint32_t));
+    if(bucket_end == NULL || positions == NULL){
+        free(bucket_end);
+        free(positions);
+        return -1;
+    }
+
+    //count the trigrams, then turn the counts into where each bucket ends
+    uint32_t key = 0;
+    int64_t num_entries = 0; //trigrams present in the slice
+    for(int64_t j = 0; j < n; j++){
+        key = ((uint32_t)s[j] << 16) | ((uint32_t)s[j + 1] << 8) | s[j + 2];
+        if(bucket_end[key]++ == 0){
+            num_entries++;
+        }
+    }
+    uint32_t total = 0;
+    for(uint32_t k = 0; k < NGRAM_KEYS; k++){
+        uint32_t count = bucket_end[k];
+        bucket_end[k] = total; //start for now, the fill moves it to the end
+        total += count;
+    }
+    for(int64_t j = 0; j < n; j++){
+        key = ((uint32_t)s[j] << 16) | ((uint32_t)s[j + 1] << 8) | s[j + 2];
+        positions[bucket_end[key]++] = j;
+    }
+
+    //differences between positions of a bucket are below 2^32, 5 bytes each
+    int64_t worst = sizeof(int64_t) + num_entries * sizeof(ngram_entry) + 5 * n + 8;
+    char* out = (char *)malloc(worst);
+    if(out == NULL){
+        free(bucket_end);
+        free(positions);
+        return -1;
+    }
+    memcpy(out, &num_entries, sizeof(int64_t));
+    ngram_entry* entries = (ngram_entry *)(out + sizeof(int64_t));
+    unsigned char* encoded = (unsigned char *)(entries + num_entries);
+    int64_t e = 0;
+    uint32_t start = 0; //first position of the current bucket
+    for(uint32_t k = 0; k < NGRAM_KEYS; k++){
+        if(bucket_end[k] == start){
+            continue;
+        }
+        entries[e].trigram = k;
+        entries[e].count = bucket_end[k] - start;
+        entries[e].offset = (char *)encoded - out;
+        uint32_t previous = 0;
+        for(uint32_t i = start; i < bucket_end[k]; i++){
+            encoded += varint_encode(positions[i] - previous, encoded);
+            previous = positions[i];
+        }
+        start = bucket_end[k];
+        e++;
+    }
+    free(bucket_end);
+    free(positions);
+
+    int64_t size = (char *)encoded - out;
+    while(size % 8 != 0){
+        out[size++] = 0;
+    }
+    char* shrunk = (char *)realloc(out, size);
+    *block = (shrunk != NULL) ? shrunk : out;
+    *block_size = size;
+    return 0;
+}
+
+size_t ngram_header_size(int64_t num_partitions){
+    return sizeof(ngram_header) + num_partitions * sizeof(ngram_partition);
+}
+
+int ngram_open(ngram_index* index, const char* path){
+    memset(index, 0, sizeof(ngram_index));
+    int fd = open(path, O_RDONLY);
+    if(fd == -1){
+        return -1;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(ngram_header)){
+        close(fd);
+        return -1;
+    }
+    void* map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); //the mapping stays valid without the descriptor
+    if(map == MAP_FAILED){
+        return -1;
+    }
+    index->map = (const char *)map;
+    index->map_size = info.st_size;
+    index->header = (const ngram_header *)map;
+    index->partitions = (const ngram_partition *)(index->map + sizeof(ngram_header));
+
+    //every partition has to lie inside the file and hold its entries
+    int64_t partitions = index->header->num_partitions;
+    int valid = index->header->magic == NGRAM_MAGIC && partitions > 0 &&
+                partitions <= (int64_t)(index->map_size / sizeof(ngram_partition)) &&
+                ngram_header_size(partitions) <= index->map_size;
+    for(int64_t k = 0; valid && k < partitions; k++){
+        const ngram_partition* part = &index->partitions[k];
+        valid = part->offset >= (int64_t)ngram_header_size(partitions) &&
+                part->offset % 8 == 0 && part->size >= (int64_t)sizeof(int64_t) &&
+                part->offset <= (int64_t)index->map_size - part->size &&
+                part->start >= 0 && part->length >= 0;
+        if(valid){
+            int64_t num_entries;
+            memcpy(&num_entries, index->map + part->offset, sizeof(int64_t));
+            valid = num_entries >= 0 &&
+                    num_entries <= (int64_t)((part->size - sizeof(int64_t)) / sizeof(ngram_entry));
+        }
+    }
+    if(!valid){
+        ngram_close(index);
+        return -1;
+    }
+    return 0;
+}
+
+int64_t ngram_candidates(const ngram_index* index, const char* pattern,
+                         size_t length, int64_t begin, int64_t end,
+                         int64_t** candidates){
+    const unsigned char* s = (const unsigned char *)pattern;
+    int64_t grams = length - (NGRAM_LENGTH - 1); //trigrams in the pattern
+    *candidates = NULL;
+    if(grams <= 0 || begin >= end){
+        return 0;
+    }
+    uint32_t* keys = (uint32_t *)malloc(grams * sizeof(uint32_t));
+    int64_t* counts = (int64_t *)malloc(grams * sizeof(int64_t));
+    int64_t* order = (int64_t *)malloc(grams * sizeof(int64_t));
+    if(keys == NULL || counts == NULL || order == NULL){
+        free(keys);
+        free(counts);
+        free(order);
+        return -1;
+    }
+
+    //how often every trigram of the pattern occurs in the whole file
+    for(int64_t i = 0; i < grams; i++){
+        keys[i] = ((uint32_t)s[i] << 16) | ((uint32_t)s[i + 1] << 8) | s[i + 2];
+        counts[i] = 0;
+        for(int64_t k = 0; k < index->header->num_partitions; k++){
+            const ngram_entry* entry = find_entry(index, k, keys[i]);
+            if(entry != NULL){
+                counts[i] += entry->count;
+            }
+        }
+        //insertion sort by count, patterns are short
+        int64_t j = i;
+        while(j > 0 && counts[order[j - 1]] > counts[i]){
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    int64_t found = 0; //candidates left
+    int64_t found_capacity = 0;
+    int64_t* next = NULL; //positions of the trigram being intersected
+    int64_t next_capacity = 0;
+    if(counts[order[0]] > 0){
+        //every occurence has the rarest trigram at its offset
+        int64_t shift = order[0];
+        found = positions_between(index, keys[shift], begin + shift, end + shift,
+                                  candidates, &found_capacity);
+        for(int64_t j = 0; j < found; j++){
+            (*candidates)[j] -= shift;
+        }
+        //keep the candidates that have the next rarest trigrams at their offsets
+        for(int64_t r = 1; r < grams && found > NGRAM_FEW; r++){
+            shift = order[r];
+            int64_t count = positions_between(index, keys[shift], begin + shift,
+                                              end + shift, &next, &next_capacity);
+            if(count < 0){
+                found = -1;
+                break;
+            }
+            int64_t kept = 0;
+            int64_t j = 0;
+            for(int64_t c = 0; c < found; c++){
+                int64_t wanted = (*candidates)[c] + shift;
+                while(j < count && next[j] < wanted){
+                    j++;
+                }
+                if(j < count && next[j] == wanted){
+                    (*candidates)[kept++] = (*candidates)[c];
+                }
+            }
+            found = kept;
+        }
+    }
+    free(next);
+    free(keys);
+    free(counts);
+    free(order);
+    if(found < 0){
+        free(*candidates);
+        *candidates = NULL;
+    }
+    return found;
+}
+
+void ngram_close(ngram_index* index){
+    if(index->map != NULL){
+        munmap((void *)index->map, index->map_size);
+    }
+    memset(index, 0, sizeof(ngram_index));
+}
+
+static int64_t positions_between(const ngram_index* index, uint32_t trigram,
+                                 int64_t begin, int64_t end, int64_t** positions,
+                                 int64_t* capacity){
+    int64_t count = 0;
+    for(int64_t k = 0; k < index->header->num_partitions; k++){
+        const ngram_partition* part = &index->partitions[k];
+        if(part->start >= end || part->start + part->length <= begin){
+            continue;
+        }
+        const ngram_entry* entry = find_entry(index, k, trigram);
+        if(entry == NULL){
+            continue;
+        }
+        if(count + entry->count > *capacity){
+            int64_t grown = *capacity ? 2 * *capacity : 1024;
+            while(grown < count + entry->count){
+                grown *= 2;
+            }
+            int64_t* bigger = (int64_t *)realloc(*positions, grown * sizeof(int64_t));
+            if(bigger == NULL){
+                return -1;
+            }
+            *positions = bigger;
+            *capacity = grown;
+        }
+        const unsigned char* partition = (const unsigned char *)index->map + part->offset;
+        const unsigned char* in = partition + entry->offset;
+        const unsigned char* stop = partition + part->size;
+        if(entry->offset > (uint64_t)part->size){
+            return -1;
+        }
+        int64_t position = part->start;
+        for(uint32_t i = 0; i < entry->count; i++){
+            uint64_t difference;
+            size_t used = varint_decode(in, stop, &difference);
+            if(used == 0){
+                return -1;
+            }
+            in += used;
+            position += difference;
+            if(position >= begin && position < end){
+                (*positions)[count++] = position;
+            }
+        }
+    }
+    return count;
+}
+
+static const ngram_entry* find_entry(const ngram_index* index, int64_t partition,
+                                     uint32_t trigram){
+    const char* start = index->map + index->partitions[partition].offset;
+    int64_t num_entries;
+    memcpy(&num_entries, start, sizeof(int64_t));
+    const ngram_entry* entries = (const ngram_entry *)(start + sizeof(int64_t));
+    int64_t low = 0, high = num_entries; //search in [low, high)
+    while(low < high){
+        int64_t middle = low + (high - low) / 2;
+        if(entries[middle].trigram < trigram){
+            low = middle + 1;
+        }else{
+            high = middle;
+        }
+    }
+    if(low < num_entries && entries[low].trigram == trigram){
+        return &entries[low];
+    }
+    return NULL;
+}
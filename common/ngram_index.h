@@ -0,0 +1,129 @@
+/******************************************************************************
+Title : ngram_index.h
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Trigram index of a file, so repeated searches over the same
+file only look at the places that can hold the pattern. The index is made of
+partitions, one per slice of the file, each listing for every trigram the
+positions in its slice where the trigram starts. Positions are stored as
+varint encoded differences (common/varint.c). Building a partition needs
+nothing but the slice, so every processor of an MPI program can index its
+own slice and write its partition next to the others.
+
+Layout of an index file, all numbers in native byte order:
+    ngram_header
+    ngram_partition[num_partitions] (in the order of the slices)
+    the partitions, each one
+        int64_t number of trigrams
+        ngram_entry[number of trigrams] (ordered by trigram)
+        the encoded positions of every trigram, one list after the other
+
+A query decodes the positions of the pattern's rarest trigram, keeps the
+ones where the next rarest trigrams are at the right distance and leaves
+the few candidates left to be verified against the file.
+
+Build with: compile ngram_index.c and varint.c along with the program using it
+******************************************************************************/
+#ifndef NGRAM_INDEX_H
+#define NGRAM_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define NGRAM_MAGIC 0x4e4752414d494458LL //"NGRAMIDX", marks a valid index file
+#define NGRAM_LENGTH 3 //bytes in an n-gram, shorter patterns can not use the index
+
+typedef struct ngram_header{
+    int64_t magic; //NGRAM_MAGIC
+    int64_t num_partitions; //number of partitions
+    int64_t file_size; //size of the indexed file
+    int64_t file_mtime; //modification time of the indexed file, seconds
+    int64_t file_mtime_nsec; //and nanoseconds
+    int64_t reserved[3]; //pads the header to 64 bytes
+} ngram_header;
+
+typedef struct ngram_partition{
+    int64_t start; //index in the file of the slice
+    int64_t length; //number of positions in the slice
+    int64_t offset; //where the partition starts in the index file
+    int64_t size; //bytes in the partition
+} ngram_partition;
+
+typedef struct ngram_entry{
+    uint32_t trigram; //the three bytes, first one in the high bits
+    uint32_t count; //number of positions of the trigram in the slice
+    uint64_t offset; //where its positions start, from the start of the partition
+} ngram_entry;
+
+typedef struct ngram_index{
+    const ngram_header* header; //header of the mapped index
+    const ngram_partition* partitions; //partition table of the mapped index
+    const char* map; //the whole index file, memory mapped
+    size_t map_size; //size of the index file
+} ngram_index;
+
+int ngram_build(const char* slice, int64_t slice_length, int64_t owned,
+                char** block, int64_t* block_size);
+/**
+ * @param: slice of the file, bytes in the slice, number of positions owned
+ *         (the slice holds NGRAM_LENGTH - 1 bytes past them when the file
+ *         goes on), where to store the partition and its size
+ *
+ * @brief: counts every trigram of the owned positions, buckets the
+ * positions by trigram and encodes the buckets as one partition. The size
+ * is padded to a multiple of 8 so partitions stay aligned in the file
+ *
+ * @return: 0 on success, -1 if the slice has more than 2^32 positions or
+ * memory ran out
+ *
+*/
+
+size_t ngram_header_size(int64_t num_partitions);
+/**
+ * @param: number of partitions
+ *
+ * @brief: bytes taken by the header and the partition table, the first
+ * partition starts right after them
+ *
+ * @return: size_t size in bytes
+ *
+*/
+
+int ngram_open(ngram_index* index, const char* path);
+/**
+ * @param: index to fill in, name of the index file
+ *
+ * @brief: memory maps the index file and checks its header and partition
+ * table
+ *
+ * @return: 0 on success, -1 if the file can not be mapped or is not an index
+ *
+*/
+
+int64_t ngram_candidates(const ngram_index* index, const char* pattern,
+                         size_t length, int64_t begin, int64_t end,
+                         int64_t** candidates);
+/**
+ * @param: opened index, pattern of at least NGRAM_LENGTH bytes, its length,
+ *         first and last (excluded) positions to look at, where to store the
+ *         candidates (allocated here, freed by the caller)
+ *
+ * @brief: intersects the positions of the pattern's trigrams, rarest first,
+ * and stops once few candidates are left. Every occurence of the pattern
+ * starting in [begin, end) is among the candidates, in increasing order
+ *
+ * @return: int64_t number of candidates, -1 if the index is corrupted or
+ * memory ran out
+ *
+*/
+
+void ngram_close(ngram_index* index);
+/**
+ * @param: index to release
+ *
+ * @brief: unmaps the index file
+ *
+*/
+
+#endif
@@ -0,0 +1,1391 @@
+/******************************************************************************
+Title : regex_dfa.c
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Implementation of the regular expression DFA described in
+regex_dfa.h. The parser is a recursive descent over the expression that
+builds Thompson fragments directly, every fragment ends in an epsilon state
+whose out edge is patched when the fragment is connected. Bounded repetitions
+reparse their atom for every copy instead of copying fragments. The reverse
+DFA is a second subset construction over the same NFA, its sets are built
+from the class states whose following closure meets the set after them.
+The reverse scan marks the starts it finds in a bitmap, one bit per position,
+and reports them front to back once the pass is over.
+
+Build with: compile regex_dfa.c and match.c along with the program using it
+******************************************************************************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "regex_dfa.h"
+
+#define REGEX_MAGIC 0x52454731 //"REG1", marks a valid DFA block
+#define REGEX_HEADER 10 //int32 fields at the start of the block
+#define REGEX_MAX_PREFIX 255 //longest literal prefix extracted
+#define REGEX_MAX_NFA 200000 //largest NFA the parser builds
+
+#define NFA_CLASS 0 //consumes a byte of its set and goes to out
+#define NFA_SPLIT 1 //goes to out and out1 without consuming
+#define NFA_EPSILON 2 //goes to out without consuming
+#define NFA_MATCH 3 //end of a match
+
+typedef struct nfa_state{
+    int type; //one of the NFA_ kinds
+    int out; //next state, -1 while unpatched
+    int out1; //second next state of a split
+    int set; //index of the byte set of a class state
+} nfa_state;
+
+typedef struct fragment{
+    int start; //first state of the fragment
+    int end; //epsilon state whose out is patched to what follows
+} fragment;
+
+typedef struct parser{
+    const unsigned char* pattern; //expression being parsed
+    size_t length; //length of the expression
+    size_t pos; //next byte to parse
+    nfa_state* states; //NFA states built so far
+    int num_states;
+    int states_capacity;
+    unsigned char (*sets)[32]; //256 bit byte sets of the class states
+    int num_sets;
+    int sets_capacity;
+    char* error; //message of the first error
+    size_t error_size;
+    int failed; //1 once an error happened
+    int parsed; //1 after parsing, errors no longer have an offset
+    int ignore_case; //1 when byte sets hold both cases of their letters
+} parser;
+
+typedef struct subset_table{
+    const nfa_state* states; //NFA the subsets are made of
+    int32_t num_classes;
+    int* store; //NFA states of every DFA state, one after the other
+    int* offset; //DFA state -> start of its NFA states in store
+    int capacity; //ints store has room for
+    int32_t count; //number of DFA states
+    int32_t* table; //open addressing hash table of DFA states, -1 is empty
+    int table_size;
+    unsigned char* accept; //1 for DFA states holding the match state
+} subset_table;
+
+typedef struct scan_context{
+    const regex_dfa* re;
+    const unsigned char* text;
+    size_t text_length;
+    int at_end;
+    regex_report report;
+    void* arg;
+    size_t found; //number of matches reported
+    size_t undecided; //first candidate that ran out of text, SIZE_MAX if none
+} scan_context;
+
+static void fail(parser* ps, const char* message);
+/**
+ * @param: parser, error message
+ *
+ * @brief: records the first error and the position it happened at
+ *
+*/
+static int new_state(parser* ps, int type, int out, int out1, int set);
+static int new_set(parser* ps);
+/**
+ * @param: parser (and the fields of the state)
+ *
+ * @brief: appends a state (an empty byte set) to the NFA, growing it
+ *
+ * @return: int index of the new state (set), -1 on failure
+ *
+*/
+static fragment class_fragment(parser* ps, int set);
+static fragment empty_fragment(parser* ps);
+static fragment concat(parser* ps, fragment a, fragment b);
+static fragment alternate(parser* ps, fragment a, fragment b);
+static fragment star(parser* ps, fragment a);
+static fragment optional(parser* ps, fragment a);
+/**
+ * @param: parser, fragments to combine
+ *
+ * @brief: Thompson constructions, every result ends in an unpatched
+ * epsilon state
+ *
+ * @return: fragment of the combination
+ *
+*/
+static fragment parse_alternation(parser* ps);
+static fragment parse_concatenation(parser* ps);
+static fragment parse_repetition(parser* ps);
+static fragment parse_atom(parser* ps);
+static void parse_class(parser* ps, unsigned char* set);
+static int parse_escape(parser* ps, unsigned char* set);
+static void fold_set(unsigned char* set);
+/**
+ * @param: parser (and the set an escape or class adds its bytes to)
+ *
+ * @brief: recursive descent over the grammar
+ *   alternation := concatenation ('|' concatenation)*
+ *   concatenation := repetition*
+ *   repetition := atom ('*' | '+' | '?' | '{m}' | '{m,}' | '{m,n}')?
+ *   atom := '(' alternation ')' | '[' class ']' | '.' | escape | byte
+ *
+ * @return: fragment of what was parsed (parse_escape returns the byte of a
+ * single byte escape or -1 when it added a class)
+ *
+ * fold_set adds the other case of every letter in a set when ignoring case
+ *
+*/
+static int closure(const nfa_state* states, int* list, int count, int* mark,
+                   int generation, int* stack);
+/**
+ * @param: NFA states, list of states (overwritten with its closure), number
+ *         of states in the list, mark array, generation of this closure,
+ *         scratch stack
+ *
+ * @brief: follows split and epsilon edges, keeping only class and match
+ * states, and sorts the result so equal sets compare equal
+ *
+ * @return: int number of states in the closure
+ *
+*/
+static int compare_int(const void* a, const void* b);
+static int subset_init(subset_table* sub, const nfa_state* states, int32_t num_classes);
+static void subset_free(subset_table* sub);
+/**
+ * @param: table of DFA states (the NFA and the number of byte classes)
+ *
+ * @brief: allocates the table with only the dead state in it (frees what
+ * subset_init allocated but the accept array, which the caller keeps)
+ *
+ * @return: int 0 on success, -1 if memory ran out
+ *
+*/
+static int32_t add_subset(subset_table* sub, const int* list, int count);
+/**
+ * @param: table of DFA states, sorted set of NFA states, its size
+ *
+ * @brief: looks the set up and makes it a new DFA state when it is new
+ *
+ * @return: int32_t DFA state of the set (0 for the empty set), -1 if there
+ * are already REGEX_MAX_STATES states, -2 if memory ran out
+ *
+*/
+static int32_t build_reverse(const parser* ps, int start, int match_state,
+                             const int* representative, int32_t num_classes,
+                             int32_t** rev_next, unsigned char** rev_accept,
+                             int32_t* rev_start, int32_t* rev_open);
+/**
+ * @param: parser holding the NFA, its start and match states, a byte of
+ *         every class, number of classes, where to store the transitions,
+ *         the accepting states and the two starting states
+ *
+ * @brief: subset construction of the reverse DFA. Reading byte b in front
+ * of a set keeps the class states holding b whose following closure meets
+ * the set, and the match state, which finishes a match right there. A set
+ * accepts when it meets the closure of the start
+ *
+ * @return: int32_t number of reverse states, 0 if there would be more than
+ * REGEX_MAX_STATES, -1 if memory ran out
+ *
+*/
+static size_t reverse_scan(const regex_dfa* re, const unsigned char* text,
+                           size_t text_length, size_t starts, int at_end,
+                           uint64_t* marks, regex_report report,
+                           regex_pending pending, void* arg);
+/**
+ * @param: DFA, text and its length, number of starting positions, 1 if the
+ *         text ends the input, zeroed bitmap of starts bits, callbacks of
+ *         regex_scan and their argument
+ *
+ * @brief: runs the reverse DFA once from the end of the text to the front,
+ * with the open state next to it until they agree when the input goes on,
+ * marks the starts and reports the decided ones in order
+ *
+ * @return: number of matches reported
+ *
+*/
+static void mark_occurence(size_t position, void* arg);
+/**
+ * @param: position of an occurence of the prefix, bitmap of reverse_scan
+ *
+ * @brief: report callback of the prefix matcher, sets the position's bit
+ *
+*/
+static int32_t state_before(const regex_dfa* re, const unsigned char* text,
+                            size_t q, size_t j, int32_t state);
+/**
+ * @param: DFA, text, position of an occurence of the prefix, position past
+ *         it whose reverse state is known, that state
+ *
+ * @brief: reverse state at the occurence. The bytes right after it usually
+ * decide it, so the exact and the open state are run from a window past the
+ * prefix until they agree, the window doubling while they do not. Once it
+ * reaches j the state is run from j, so every byte is read a bounded number
+ * of times
+ *
+ * @return: int32_t reverse state at q
+ *
+*/
+static void run_candidate(scan_context* ctx, size_t position, int32_t state, size_t j);
+/**
+ * @param: scan context, position of the candidate, DFA state, index of the
+ *         next byte to read
+ *
+ * @brief: fallback without the reverse DFA, runs the DFA from a candidate
+ * until it accepts, dies or runs out of text and reports the outcome. After
+ * the first candidate that ran out of text the later ones are left to the
+ * caller as well
+ *
+*/
+static void prefix_candidate(size_t position, void* arg);
+/**
+ * @param: position of an occurence of the literal prefix, scan context
+ *
+ * @brief: match_report callback that resumes the DFA after the prefix
+ *
+*/
+static size_t block_layout(int32_t num_states, int32_t num_classes,
+                           int32_t prefix_length, int32_t rev_states);
+static void point_arrays(regex_dfa* re);
+/**
+ * @param: shape of the DFA (or the DFA with its block set)
+ *
+ * @brief: size of the block and placement of the arrays inside it
+ *
+*/
+
+int regex_compile(regex_dfa* re, const char* pattern, size_t length,
+                  int flags, char* error, size_t error_size){
+    memset(re, 0, sizeof(regex_dfa));
+    parser ps;
+    memset(&ps, 0, sizeof(parser));
+    ps.pattern = (const unsigned char *)pattern;
+    ps.length = length;
+    ps.error = error;
+    ps.error_size = error_size;
+    ps.ignore_case = (flags & REGEX_IGNORE_CASE) != 0;
+    if(error_size > 0){
+        error[0] = '\0';
+    }
+
+    //parse into an NFA and close it with a match state
+    fragment whole = parse_alternation(&ps);
+    if(!ps.failed && ps.pos < ps.length){
+        fail(&ps, "unmatched )");
+    }
+    int match_state = ps.failed ? -1 : new_state(&ps, NFA_MATCH, -1, -1, -1);
+    if(ps.failed){
+        free(ps.states);
+        free(ps.sets);
+        return -1;
+    }
+    ps.states[whole.end].out = match_state;
+    ps.parsed = 1;
+
+    //bytes are in the same class when every set agrees on them
+    unsigned char byte_class[256]; //byte -> class
+    int32_t num_classes = 1;
+    memset(byte_class, 0, sizeof(byte_class));
+    for(int s = 0; s < ps.num_sets; s++){
+        int split[2 * 256]; //(old class, in set) -> new class
+        int refined = 0;
+        memset(split, -1, sizeof(split));
+        for(int b = 0; b < 256; b++){
+            int in = (ps.sets[s][b >> 3] >> (b & 7)) & 1;
+            int key = 2 * byte_class[b] + in;
+            if(split[key] == -1){
+                split[key] = refined++;
+            }
+            byte_class[b] = split[key];
+        }
+        num_classes = refined;
+    }
+    int representative[256]; //a byte of each class
+    for(int b = 255; b >= 0; b--){
+        representative[byte_class[b]] = b;
+    }
+
+    //subset construction, DFA state 0 is the dead (empty) set
+    int n = ps.num_states;
+    subset_table sub;
+    int subset_failed = subset_init(&sub, ps.states, num_classes);
+    int32_t* next = (int32_t *)malloc((size_t)REGEX_MAX_STATES * num_classes * sizeof(int32_t));
+    int* mark = (int *)calloc(n, sizeof(int));
+    int* stack = (int *)malloc(n * sizeof(int));
+    int* list = (int *)malloc(n * sizeof(int));
+    if(subset_failed || next == NULL || mark == NULL || stack == NULL || list == NULL){
+        fail(&ps, "out of memory");
+    }
+    int32_t start = 0;
+    int generation = 0;
+    if(!ps.failed){
+        list[0] = whole.start;
+        int count = closure(ps.states, list, 1, mark, ++generation, stack);
+        start = add_subset(&sub, list, count);
+        if(start < 0){
+            fail(&ps, start == -1 ? "expression needs too many DFA states" : "out of memory");
+        }
+    }
+    //expand the DFA states in the order they were created
+    for(int32_t d = 1; !ps.failed && d < sub.count; d++){
+        for(int32_t c = 0; c < num_classes; c++){
+            next[(size_t)d * num_classes + c] = 0;
+            if(sub.accept[d]){
+                continue; //the scan stops at the first accepting state
+            }
+            int b = representative[c];
+            int count = 0;
+            for(int i = sub.offset[d]; i < sub.offset[d + 1]; i++){
+                nfa_state* st = &ps.states[sub.store[i]];
+                if(st->type == NFA_CLASS && ((ps.sets[st->set][b >> 3] >> (b & 7)) & 1)){
+                    list[count++] = st->out;
+                }
+            }
+            count = closure(ps.states, list, count, mark, ++generation, stack);
+            int32_t target = add_subset(&sub, list, count);
+            if(target < 0){
+                fail(&ps, target == -1 ? "expression needs too many DFA states" : "out of memory");
+                break;
+            }
+            next[(size_t)d * num_classes + c] = target;
+        }
+    }
+    int32_t num_states = sub.count;
+    unsigned char* accept = sub.accept;
+    if(!ps.failed){
+        for(int32_t c = 0; c < num_classes; c++){
+            next[c] = 0; //the dead state stays dead
+        }
+    }
+    free(mark);
+    free(stack);
+    free(list);
+    subset_free(&sub);
+
+    //reverse DFA, without it the scan falls back to the forward one
+    int32_t rev_states = 0;
+    int32_t* rev_next = NULL;
+    unsigned char* rev_accept = NULL;
+    int32_t rev_start = 0, rev_open = 0;
+    if(!ps.failed){
+        rev_states = build_reverse(&ps, whole.start, match_state, representative,
+                                   num_classes, &rev_next, &rev_accept,
+                                   &rev_start, &rev_open);
+        if(rev_states < 0){
+            fail(&ps, "out of memory");
+        }
+    }
+    free(ps.states);
+    free(ps.sets);
+    if(ps.failed){
+        free(next);
+        free(accept);
+        free(rev_next);
+        free(rev_accept);
+        return -1;
+    }
+
+    //literal prefix: follow the start state while a single byte keeps it alive
+    unsigned char prefix[REGEX_MAX_PREFIX];
+    int32_t prefix_length = 0;
+    int32_t state = start;
+    while(!accept[state] && prefix_length < REGEX_MAX_PREFIX){
+        int alive = 0; //bytes that do not lead to the dead state
+        int only = 0; //the last such byte
+        for(int b = 0; b < 256 && alive < 2; b++){
+            if(next[(size_t)state * num_classes + byte_class[b]] != 0){
+                alive++;
+                only = b;
+            }
+        }
+        if(alive != 1){
+            break;
+        }
+        prefix[prefix_length++] = only;
+        state = next[(size_t)state * num_classes + byte_class[only]];
+    }
+
+    //bytes that take the reverse DFA out of its state without an open match
+    unsigned char last_byte[256];
+    int32_t last_only = -1;
+    int num_last = 0;
+    for(int b = 0; b < 256; b++){
+        last_byte[b] = rev_states > 0 &&
+            rev_next[(size_t)rev_start * num_classes + byte_class[b]] != rev_start;
+        if(last_byte[b]){
+            num_last++;
+            last_only = b;
+        }
+    }
+    if(num_last != 1){
+        last_only = -1;
+    }
+
+    //move everything into one block
+    re->block_size = block_layout(num_states, num_classes, prefix_length, rev_states);
+    re->block = (char *)malloc(re->block_size);
+    if(re->block == NULL){
+        free(next);
+        free(accept);
+        free(rev_next);
+        free(rev_accept);
+        if(error_size > 0){
+            snprintf(error, error_size, "out of memory");
+        }
+        return -1;
+    }
+    int32_t* header = (int32_t *)re->block;
+    memset(header, 0, REGEX_HEADER * sizeof(int32_t));
+    header[0] = REGEX_MAGIC;
+    header[1] = num_states;
+    header[2] = num_classes;
+    header[3] = start;
+    header[4] = state;
+    header[5] = prefix_length;
+    header[6] = rev_states;
+    header[7] = rev_start;
+    header[8] = rev_open;
+    header[9] = last_only;
+    re->num_states = num_states;
+    re->num_classes = num_classes;
+    re->prefix_length = prefix_length;
+    re->rev_states = rev_states;
+    point_arrays(re);
+    memcpy((unsigned char *)re->byte_class, byte_class, 256);
+    memcpy((int32_t *)re->next, next, (size_t)num_states * num_classes * sizeof(int32_t));
+    memcpy((unsigned char *)re->accept, accept, num_states);
+    memcpy((unsigned char *)re->prefix, prefix, prefix_length);
+    memcpy((unsigned char *)re->last_byte, last_byte, 256);
+    if(rev_states > 0){
+        memcpy((int32_t *)re->rev_next, rev_next,
+               (size_t)rev_states * num_classes * sizeof(int32_t));
+        memcpy((unsigned char *)re->rev_accept, rev_accept, rev_states);
+    }
+    for(int b = 0; b < 256; b++){
+        ((unsigned char *)re->first_byte)[b] = accept[start] ||
+            next[(size_t)start * num_classes + byte_class[b]] != 0;
+    }
+    free(next);
+    free(accept);
+    free(rev_next);
+    free(rev_accept);
+
+    //the block is complete, attach to it like a receiving processor would
+    char* block = re->block;
+    size_t block_size = re->block_size;
+    if(regex_attach(re, block, block_size) != 0){
+        free(block);
+        if(error_size > 0){
+            snprintf(error, error_size, "out of memory");
+        }
+        return -1;
+    }
+    return 0;
+}
+
+int regex_attach(regex_dfa* re, char* block, size_t block_size){
+    memset(re, 0, sizeof(regex_dfa));
+    if(block_size < REGEX_HEADER * sizeof(int32_t)){
+        return -1;
+    }
+    int32_t* header = (int32_t *)block;
+    if(header[0] != REGEX_MAGIC || header[1] <= 0 || header[2] <= 0 ||
+       header[3] < 0 || header[3] >= header[1] || header[4] < 0 ||
+       header[4] >= header[1] || header[5] < 0 || header[5] > REGEX_MAX_PREFIX ||
+       header[6] < 0 || header[6] > REGEX_MAX_STATES ||
+       (header[6] > 0 && (header[7] <= 0 || header[7] >= header[6] ||
+                          header[8] <= 0 || header[8] >= header[6])) ||
+       header[9] < -1 || header[9] > 255 ||
+       block_layout(header[1], header[2], header[5], header[6]) != block_size){
+        return -1;
+    }
+    re->num_states = header[1];
+    re->num_classes = header[2];
+    re->start = header[3];
+    re->after_prefix = header[4];
+    re->prefix_length = header[5];
+    re->rev_states = header[6];
+    re->rev_start = header[7];
+    re->rev_open = header[8];
+    re->last_only = header[9];
+    re->block = block;
+    re->block_size = block_size;
+    point_arrays(re);
+    if(re->prefix_length > 0 &&
+       matcher_init(&re->prefix_matcher, (const char *)re->prefix, re->prefix_length) != 0){
+        memset(re, 0, sizeof(regex_dfa));
+        return -1;
+    }
+    return 0;
+}
+
+size_t regex_scan(const regex_dfa* re, const char* text, size_t text_length,
+                  size_t starts, int at_end, regex_report report,
+                  regex_pending pending, void* arg){
+    if(starts > text_length){
+        starts = text_length;
+    }
+    if(re->rev_states > 0){
+        //one bit per starting position, the pass finds them back to front
+        uint64_t* marks = (uint64_t *)calloc(starts / 64 + 1, sizeof(uint64_t));
+        if(marks != NULL){
+            size_t found = reverse_scan(re, (const unsigned char *)text, text_length,
+                                        starts, at_end, marks, report, pending, arg);
+            free(marks);
+            return found;
+        }
+        //the forward scan needs no memory, it is only slower
+    }
+
+    scan_context ctx;
+    ctx.re = re;
+    ctx.text = (const unsigned char *)text;
+    ctx.text_length = text_length;
+    ctx.at_end = at_end;
+    ctx.report = report;
+    ctx.arg = arg;
+    ctx.found = 0;
+    ctx.undecided = SIZE_MAX;
+    if(re->prefix_length > 0){
+        //jump between occurences of the prefix and resume the DFA after it
+        matcher_scan(&re->prefix_matcher, text, text_length, starts,
+                     prefix_candidate, &ctx);
+        if(!at_end){
+            //prefixes cut off by the end of the text are still undecided
+            size_t tail = (text_length >= (size_t)re->prefix_length) ?
+                          text_length - re->prefix_length + 1 : 0;
+            for(size_t p = tail; p < starts; p++){
+                run_candidate(&ctx, p, re->start, p);
+            }
+        }
+    }else{
+        //skip the bytes no match can start with
+        for(size_t p = 0; p < starts; p++){
+            if(re->first_byte[ctx.text[p]]){
+                run_candidate(&ctx, p, re->start, p);
+            }
+        }
+    }
+    if(ctx.undecided != SIZE_MAX && pending != NULL){
+        pending(ctx.undecided, arg);
+    }
+    return ctx.found;
+}
+
+void regex_free(regex_dfa* re){
+    if(re->prefix_length > 0){
+        matcher_free(&re->prefix_matcher);
+    }
+    free(re->block);
+    memset(re, 0, sizeof(regex_dfa));
+}
+
+static size_t reverse_scan(const regex_dfa* re, const unsigned char* text,
+                           size_t text_length, size_t starts, int at_end,
+                           uint64_t* marks, regex_report report,
+                           regex_pending pending, void* arg){
+    const int32_t* next = re->rev_next;
+    const unsigned char* byte_class = re->byte_class;
+    int32_t num_classes = re->num_classes;
+    int32_t state = re->rev_start; //no match runs past the text
+    int32_t open = at_end ? state : re->rev_open; //any match may
+    size_t undecided = SIZE_MAX; //lowest position only the open state accepts
+    size_t j = text_length;
+
+    //the open state holds every set the bytes past the text could give, so
+    //once the two agree the positions in front are decided whatever follows
+    while(j > 0 && open != state){
+        j--;
+        int32_t c = byte_class[text[j]];
+        state = next[(size_t)state * num_classes + c];
+        open = next[(size_t)open * num_classes + c];
+        if(j < starts){
+            if(re->rev_accept[state]){
+                marks[j >> 6] |= (uint64_t)1 << (j & 63);
+            }else if(re->rev_accept[open]){
+                undecided = j;
+            }
+        }
+    }
+    //without an empty match nothing starts while no match is open
+    int skip = !re->rev_accept[re->rev_start];
+    if(re->last_only < 0 && re->prefix_length > 0){
+        //only the occurences of the prefix can start a match, the literal
+        //matcher finds them and the reverse DFA decides them one by one
+        size_t limit = (j < starts) ? j : starts;
+        matcher_scan(&re->prefix_matcher, (const char *)text, text_length,
+                     limit, mark_occurence, marks);
+        for(size_t w = (limit + 63) / 64; w > 0; w--){
+            uint64_t bits = marks[w - 1];
+            while(bits != 0){
+                int b = 63 - __builtin_clzll(bits);
+                size_t q = (w - 1) * 64 + b;
+                bits &= ~((uint64_t)1 << b);
+                if(q >= limit){
+                    continue; //decided next to the open state
+                }
+                state = state_before(re, text, q, j, state);
+                j = q;
+                if(!re->rev_accept[state]){
+                    marks[w - 1] &= ~((uint64_t)1 << b);
+                }
+            }
+        }
+        j = 0;
+    }
+    while(j > 0){
+        if(skip && state == re->rev_start){
+            if(re->last_only >= 0){
+                const unsigned char* last = memrchr(text, re->last_only, j);
+                if(last == NULL){
+                    break;
+                }
+                j = last - text + 1;
+            }else{
+                while(j > 0 && !re->last_byte[text[j - 1]]){
+                    j--;
+                }
+                if(j == 0){
+                    break;
+                }
+            }
+        }
+        j--;
+        state = next[(size_t)state * num_classes + byte_class[text[j]]];
+        if(j < starts && re->rev_accept[state]){
+            marks[j >> 6] |= (uint64_t)1 << (j & 63);
+        }
+    }
+
+    //report in order, from the undecided position on it is up to the caller
+    size_t decided = (undecided < starts) ? undecided : starts;
+    size_t found = 0;
+    for(size_t w = 0; w < (decided + 63) / 64; w++){
+        uint64_t bits = marks[w];
+        while(bits != 0){
+            size_t p = w * 64 + __builtin_ctzll(bits);
+            if(p >= decided){
+                break;
+            }
+            report(p, arg);
+            found++;
+            bits &= bits - 1;
+        }
+    }
+    if(undecided != SIZE_MAX && pending != NULL){
+        pending(undecided, arg);
+    }
+    return found;
+}
+
+static void mark_occurence(size_t position, void* arg){
+    uint64_t* marks = (uint64_t *)arg;
+    marks[position >> 6] |= (uint64_t)1 << (position & 63);
+}
+
+static int32_t state_before(const regex_dfa* re, const unsigned char* text,
+                            size_t q, size_t j, int32_t state){
+    const int32_t* next = re->rev_next;
+    int32_t num_classes = re->num_classes;
+    size_t width = 64; //bytes read past the prefix before giving up
+    while(q + re->prefix_length + width < j){
+        //whatever the state behind the window, it lies between these two
+        size_t k = q + re->prefix_length + width;
+        int32_t low = re->rev_start;
+        int32_t high = re->rev_open;
+        while(k > q && low != high){
+            k--;
+            int32_t c = re->byte_class[text[k]];
+            low = next[(size_t)low * num_classes + c];
+            high = next[(size_t)high * num_classes + c];
+        }
+        if(low == high){
+            while(k > q){
+                k--;
+                low = next[(size_t)low * num_classes + re->byte_class[text[k]]];
+            }
+            return low;
+        }
+        width *= 2;
+    }
+    while(j > q){
+        j--;
+        state = next[(size_t)state * num_classes + re->byte_class[text[j]]];
+    }
+    return state;
+}
+
+static void run_candidate(scan_context* ctx, size_t position, int32_t state, size_t j){
+    const regex_dfa* re = ctx->re;
+    if(ctx->undecided != SIZE_MAX){
+        return; //reported by the caller's next scan, in order
+    }
+    while(1){
+        if(re->accept[state]){
+            ctx->report(position, ctx->arg);
+            ctx->found++;
+            return;
+        }
+        if(state == 0){
+            return;
+        }
+        if(j == ctx->text_length){
+            if(!ctx->at_end){
+                ctx->undecided = position;
+            }
+            return;
+        }
+        state = re->next[(size_t)state * re->num_classes + re->byte_class[ctx->text[j]]];
+        j++;
+    }
+}
+
+static void prefix_candidate(size_t position, void* arg){
+    scan_context* ctx = (scan_context *)arg;
+    run_candidate(ctx, position, ctx->re->after_prefix, position + ctx->re->prefix_length);
+}
+
+static void fail(parser* ps, const char* message){
+    if(!ps->failed && ps->error_size > 0){
+        if(ps->parsed){
+            snprintf(ps->error, ps->error_size, "%s", message);
+        }else{
+            snprintf(ps->error, ps->error_size, "%s at offset %zu", message, ps->pos);
+        }
+    }
+    ps->failed = 1;
+}
+
+static int new_state(parser* ps, int type, int out, int out1, int set){
+    if(ps->failed){
+        return -1;
+    }
+    if(ps->num_states == REGEX_MAX_NFA){
+        fail(ps, "expression is too large");
+        return -1;
+    }
+    if(ps->num_states == ps->states_capacity){
+        int capacity = ps->states_capacity ? 2 * ps->states_capacity : 64;
+        nfa_state* grown = (nfa_state *)realloc(ps->states, capacity * sizeof(nfa_state));
+        if(grown == NULL){
+            fail(ps, "out of memory");
+            return -1;
+        }
+        ps->states = grown;
+        ps->states_capacity = capacity;
+    }
+    nfa_state* st = &ps->states[ps->num_states];
+    st->type = type;
+    st->out = out;
+    st->out1 = out1;
+    st->set = set;
+    return ps->num_states++;
+}
+
+static int new_set(parser* ps){
+    if(ps->failed){
+        return -1;
+    }
+    if(ps->num_sets == ps->sets_capacity){
+        int capacity = ps->sets_capacity ? 2 * ps->sets_capacity : 16;
+        unsigned char (*grown)[32] = realloc(ps->sets, capacity * sizeof(*grown));
+        if(grown == NULL){
+            fail(ps, "out of memory");
+            return -1;
+        }
+        ps->sets = grown;
+        ps->sets_capacity = capacity;
+    }
+    memset(ps->sets[ps->num_sets], 0, 32);
+    return ps->num_sets++;
+}
+
+static fragment class_fragment(parser* ps, int set){
+    fragment f;
+    f.end = new_state(ps, NFA_EPSILON, -1, -1, -1);
+    f.start = new_state(ps, NFA_CLASS, f.end, -1, set);
+    return f;
+}
+
+static fragment empty_fragment(parser* ps){
+    fragment f;
+    f.start = f.end = new_state(ps, NFA_EPSILON, -1, -1, -1);
+    return f;
+}
+
+static fragment concat(parser* ps, fragment a, fragment b){
+    if(!ps->failed){
+        ps->states[a.end].out = b.start;
+    }
+    fragment f = {a.start, b.end};
+    return f;
+}
+
+static fragment alternate(parser* ps, fragment a, fragment b){
+    fragment f;
+    f.start = new_state(ps, NFA_SPLIT, a.start, b.start, -1);
+    f.end = new_state(ps, NFA_EPSILON, -1, -1, -1);
+    if(!ps->failed){
+        ps->states[a.end].out = f.end;
+        ps->states[b.end].out = f.end;
+    }
+    return f;
+}
+
+static fragment star(parser* ps, fragment a){
+    fragment f;
+    f.end = new_state(ps, NFA_EPSILON, -1, -1, -1);
+    f.start = new_state(ps, NFA_SPLIT, a.start, f.end, -1);
+    if(!ps->failed){
+        ps->states[a.end].out = f.start;
+    }
+    return f;
+}
+
+static fragment optional(parser* ps, fragment a){
+    fragment f;
+    f.end = new_state(ps, NFA_EPSILON, -1, -1, -1);
+    f.start = new_state(ps, NFA_SPLIT, a.start, f.end, -1);
+    if(!ps->failed){
+        ps->states[a.end].out = f.end;
+    }
+    return f;
+}
+
+static fragment parse_alternation(parser* ps){
+    fragment f = parse_concatenation(ps);
+    while(!ps->failed && ps->pos < ps->length && ps->pattern[ps->pos] == '|'){
+        ps->pos++;
+        fragment g = parse_concatenation(ps);
+        f = alternate(ps, f, g);
+    }
+    return f;
+}
+
+static fragment parse_concatenation(parser* ps){
+    fragment f = empty_fragment(ps);
+    while(!ps->failed && ps->pos < ps->length &&
+          ps->pattern[ps->pos] != '|' && ps->pattern[ps->pos] != ')'){
+        fragment g = parse_repetition(ps);
+        f = concat(ps, f, g);
+    }
+    return f;
+}
+
+static fragment parse_repetition(parser* ps){
+    size_t atom_begin = ps->pos; //bounded repetitions reparse the atom from here
+    fragment f = parse_atom(ps);
+    if(ps->failed || ps->pos >= ps->length){
+        return f;
+    }
+    unsigned char c = ps->pattern[ps->pos];
+    if(c == '*'){
+        ps->pos++;
+        f = star(ps, f);
+    }else if(c == '+'){
+        ps->pos++;
+        fragment loop = star(ps, f);
+        //a+ is a followed by a*, the star loops over the same fragment
+        f.end = loop.end;
+    }else if(c == '?'){
+        ps->pos++;
+        f = optional(ps, f);
+    }else if(c == '{'){
+        //{m}, {m,} or {m,n}
+        long low = 0, high = -1;
+        ps->pos++;
+        int digits = 0;
+        while(ps->pos < ps->length && ps->pattern[ps->pos] >= '0' && ps->pattern[ps->pos] <= '9'){
+            low = low * 10 + (ps->pattern[ps->pos++] - '0');
+            digits++;
+            if(low > REGEX_MAX_REPEAT){
+                fail(ps, "repetition bound is too large");
+                return f;
+            }
+        }
+        if(digits == 0){
+            fail(ps, "repetition needs a lower bound");
+            return f;
+        }
+        high = low;
+        if(ps->pos < ps->length && ps->pattern[ps->pos] == ','){
+            ps->pos++;
+            high = -1; //unbounded unless a number follows
+            if(ps->pos < ps->length && ps->pattern[ps->pos] >= '0' && ps->pattern[ps->pos] <= '9'){
+                high = 0;
+                while(ps->pos < ps->length && ps->pattern[ps->pos] >= '0' && ps->pattern[ps->pos] <= '9'){
+                    high = high * 10 + (ps->pattern[ps->pos++] - '0');
+                    if(high > REGEX_MAX_REPEAT){
+                        fail(ps, "repetition bound is too large");
+                        return f;
+                    }
+                }
+                if(high < low){
+                    fail(ps, "repetition bounds are out of order");
+                    return f;
+                }
+            }
+        }
+        if(ps->pos >= ps->length || ps->pattern[ps->pos] != '}'){
+            fail(ps, "unterminated repetition");
+            return f;
+        }
+        ps->pos++;
+        size_t after = ps->pos; //where parsing continues
+        //m required copies, then a starred copy or n - m optional ones.
+        //The first copy is the atom already parsed, the others reparse it
+        fragment result = empty_fragment(ps);
+        long copies = (high == -1) ? low + 1 : high;
+        for(long k = 0; k < copies && !ps->failed; k++){
+            fragment copy = f;
+            if(k > 0){
+                ps->pos = atom_begin;
+                copy = parse_atom(ps);
+            }
+            if(high == -1 && k == low){
+                copy = star(ps, copy);
+            }else if(k >= low){
+                copy = optional(ps, copy);
+            }
+            result = concat(ps, result, copy);
+        }
+        ps->pos = after;
+        f = result;
+    }else{
+        return f;
+    }
+    if(ps->pos < ps->length){
+        c = ps->pattern[ps->pos];
+        if(c == '*' || c == '+' || c == '?' || c == '{'){
+            fail(ps, "nested repetition");
+        }
+    }
+    return f;
+}
+
+static fragment parse_atom(parser* ps){
+    unsigned char c = ps->pattern[ps->pos];
+    if(c == '('){
+        ps->pos++;
+        fragment f = parse_alternation(ps);
+        if(!ps->failed && (ps->pos >= ps->length || ps->pattern[ps->pos] != ')')){
+            fail(ps, "unmatched (");
+        }
+        ps->pos++;
+        return f;
+    }
+    if(c == '*' || c == '+' || c == '?' || c == '{'){
+        fail(ps, "nothing to repeat");
+        return empty_fragment(ps);
+    }
+    int set = new_set(ps);
+    if(set == -1){
+        return empty_fragment(ps);
+    }
+    unsigned char* bits = ps->sets[set];
+    if(c == '['){
+        ps->pos++;
+        parse_class(ps, bits);
+    }else if(c == '.'){
+        ps->pos++;
+        memset(bits, 0xff, 32);
+        bits['\n' >> 3] &= ~(1 << ('\n' & 7));
+    }else if(c == '\\'){
+        ps->pos++;
+        int byte = parse_escape(ps, bits);
+        if(byte >= 0){
+            bits[byte >> 3] |= 1 << (byte & 7);
+        }
+    }else{
+        ps->pos++;
+        bits[c >> 3] |= 1 << (c & 7);
+    }
+    if(ps->ignore_case){
+        fold_set(bits);
+    }
+    return class_fragment(ps, set);
+}
+
+static void parse_class(parser* ps, unsigned char* set){
+    unsigned char members[32]; //bytes named inside the brackets
+    int negate = 0;
+    int first = 1; //a ] right after [ or [^ is a literal
+    memset(members, 0, sizeof(members));
+    if(ps->pos < ps->length && ps->pattern[ps->pos] == '^'){
+        negate = 1;
+        ps->pos++;
+    }
+    while(1){
+        if(ps->pos >= ps->length){
+            fail(ps, "unterminated [");
+            return;
+        }
+        unsigned char c = ps->pattern[ps->pos];
+        if(c == ']' && !first){
+            ps->pos++;
+            break;
+        }
+        first = 0;
+        int low; //first byte of a single byte or range
+        ps->pos++;
+        if(c == '\\'){
+            low = parse_escape(ps, members);
+            if(low < 0){
+                continue; //a class escape like \d was added
+            }
+        }else{
+            low = c;
+        }
+        int high = low;
+        if(ps->pos + 1 < ps->length && ps->pattern[ps->pos] == '-' &&
+           ps->pattern[ps->pos + 1] != ']'){
+            ps->pos++;
+            unsigned char h = ps->pattern[ps->pos++];
+            if(h == '\\'){
+                unsigned char scratch[32];
+                high = parse_escape(ps, scratch);
+                if(high < 0){
+                    fail(ps, "class escape can not end a range");
+                    return;
+                }
+            }else{
+                high = h;
+            }
+            if(high < low){
+                fail(ps, "range is out of order");
+                return;
+            }
+        }
+        for(int b = low; b <= high; b++){
+            members[b >> 3] |= 1 << (b & 7);
+        }
+    }
+    if(ps->ignore_case){
+        fold_set(members); //before negating, so [^a] excludes A as well
+    }
+    for(int i = 0; i < 32; i++){
+        set[i] |= negate ? (unsigned char)~members[i] : members[i];
+    }
+}
+
+static void fold_set(unsigned char* set){
+    for(int lower = 'a'; lower <= 'z'; lower++){
+        int upper = lower - ('a' - 'A');
+        if(((set[lower >> 3] >> (lower & 7)) & 1) || ((set[upper >> 3] >> (upper & 7)) & 1)){
+            set[lower >> 3] |= 1 << (lower & 7);
+            set[upper >> 3] |= 1 << (upper & 7);
+        }
+    }
+}
+
+static int parse_escape(parser* ps, unsigned char* set){
+    if(ps->pos >= ps->length){
+        fail(ps, "trailing backslash");
+        return -1;
+    }
+    unsigned char c = ps->pattern[ps->pos++];
+    unsigned char members[32]; //bytes of a class escape
+    memset(members, 0, sizeof(members));
+    switch(c){
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        case 'f': return '\f';
+        case 'v': return '\v';
+        case 'd': case 'D':
+            for(int b = '0'; b <= '9'; b++){
+                members[b >> 3] |= 1 << (b & 7);
+            }
+            break;
+        case 'w': case 'W':
+            for(int b = 0; b < 256; b++){
+                if((b >= '0' && b <= '9') || (b >= 'a' && b <= 'z') ||
+                   (b >= 'A' && b <= 'Z') || b == '_'){
+                    members[b >> 3] |= 1 << (b & 7);
+                }
+            }
+            break;
+        case 's': case 'S':
+            members[' ' >> 3] |= 1 << (' ' & 7);
+            for(int b = '\t'; b <= '\r'; b++){
+                members[b >> 3] |= 1 << (b & 7);
+            }
+            break;
+        default:
+            //any other escaped byte stands for itself
+            return c;
+    }
+    int negate = (c == 'D' || c == 'W' || c == 'S');
+    for(int i = 0; i < 32; i++){
+        set[i] |= negate ? (unsigned char)~members[i] : members[i];
+    }
+    return -1;
+}
+
+static int closure(const nfa_state* states, int* list, int count, int* mark,
+                   int generation, int* stack){
+    int top = 0;
+    int result = 0;
+    for(int i = 0; i < count; i++){
+        if(mark[list[i]] != generation){
+            mark[list[i]] = generation;
+            stack[top++] = list[i];
+        }
+    }
+    while(top > 0){
+        int s = stack[--top];
+        const nfa_state* st = &states[s];
+        if(st->type == NFA_CLASS || st->type == NFA_MATCH){
+            list[result++] = s;
+            continue;
+        }
+        int outs[2] = {st->out, st->type == NFA_SPLIT ? st->out1 : -1};
+        for(int k = 0; k < 2; k++){
+            if(outs[k] >= 0 && mark[outs[k]] != generation){
+                mark[outs[k]] = generation;
+                stack[top++] = outs[k];
+            }
+        }
+    }
+    qsort(list, result, sizeof(int), compare_int);
+    return result;
+}
+
+static int subset_init(subset_table* sub, const nfa_state* states, int32_t num_classes){
+    memset(sub, 0, sizeof(subset_table));
+    sub->states = states;
+    sub->num_classes = num_classes;
+    sub->capacity = 1024;
+    sub->store = (int *)malloc(sub->capacity * sizeof(int));
+    sub->offset = (int *)malloc((REGEX_MAX_STATES + 1) * sizeof(int));
+    sub->table_size = 4 * REGEX_MAX_STATES;
+    sub->table = (int32_t *)malloc(sub->table_size * sizeof(int32_t));
+    sub->accept = (unsigned char *)calloc(REGEX_MAX_STATES, 1);
+    if(sub->store == NULL || sub->offset == NULL || sub->table == NULL || sub->accept == NULL){
+        return -1;
+    }
+    memset(sub->table, -1, sub->table_size * sizeof(int32_t));
+    sub->offset[0] = sub->offset[1] = 0;
+    sub->count = 1;
+    return 0;
+}
+
+static void subset_free(subset_table* sub){
+    free(sub->store);
+    free(sub->offset);
+    free(sub->table);
+    sub->store = NULL;
+    sub->offset = NULL;
+    sub->table = NULL;
+}
+
+static int32_t build_reverse(const parser* ps, int start, int match_state,
+                             const int* representative, int32_t num_classes,
+                             int32_t** rev_next, unsigned char** rev_accept,
+                             int32_t* rev_start, int32_t* rev_open){
+    int n = ps->num_states;
+    subset_table sub;
+    int subset_failed = subset_init(&sub, ps->states, num_classes);
+    int32_t* next = (int32_t *)malloc((size_t)REGEX_MAX_STATES * num_classes * sizeof(int32_t));
+    int* classes = (int *)malloc(n * sizeof(int)); //class states in order
+    int* follow_offset = (int *)malloc((n + 1) * sizeof(int)); //class -> its closure in follow
+    int* follow = NULL; //closure after every class state, one after the other
+    int* mark = (int *)calloc(n, sizeof(int));
+    int* member = (int *)calloc(n, sizeof(int)); //generation of the set being expanded
+    int* stack = (int *)malloc(n * sizeof(int));
+    int* list = (int *)malloc((n + 1) * sizeof(int));
+    unsigned char* starting = (unsigned char *)calloc(n, 1); //closure of the start
+    int32_t status = 1; //number of states once built, 0 if too many, -1 out of memory
+    if(subset_failed || next == NULL || classes == NULL || follow_offset == NULL ||
+       mark == NULL || member == NULL || stack == NULL || list == NULL || starting == NULL){
+        status = -1;
+    }
+
+    //what every class state leads to, and where a match starts
+    int generation = 0;
+    int num_class_states = 0;
+    int follow_capacity = 0;
+    if(status > 0){
+        follow_offset[0] = 0;
+        for(int q = 0; q < n && status > 0; q++){
+            if(ps->states[q].type != NFA_CLASS){
+                continue;
+            }
+            list[0] = ps->states[q].out;
+            int size = closure(ps->states, list, 1, mark, ++generation, stack);
+            int at = follow_offset[num_class_states];
+            if(at + size > follow_capacity){
+                follow_capacity = 2 * (at + size) + 64;
+                int* grown = (int *)realloc(follow, follow_capacity * sizeof(int));
+                if(grown == NULL){
+                    status = -1;
+                    break;
+                }
+                follow = grown;
+            }
+            memcpy(follow + at, list, size * sizeof(int));
+            classes[num_class_states++] = q;
+            follow_offset[num_class_states] = at + size;
+        }
+    }
+    if(status > 0){
+        list[0] = start;
+        int size = closure(ps->states, list, 1, mark, ++generation, stack);
+        for(int i = 0; i < size; i++){
+            starting[list[i]] = 1;
+        }
+        //no match open past the text, then every class state may be open.
+        //The match state is the last NFA state, so the lists stay sorted
+        list[0] = match_state;
+        *rev_start = add_subset(&sub, list, 1);
+        for(int i = 0; i < num_class_states; i++){
+            list[i] = classes[i];
+        }
+        list[num_class_states] = match_state;
+        *rev_open = add_subset(&sub, list, num_class_states + 1);
+        if(*rev_start < 0 || *rev_open < 0){
+            status = (*rev_start == -2 || *rev_open == -2) ? -1 : 0;
+        }
+    }
+    //expand the reverse states in the order they were created
+    for(int32_t d = 1; status > 0 && d < sub.count; d++){
+        ++generation;
+        for(int i = sub.offset[d]; i < sub.offset[d + 1]; i++){
+            member[sub.store[i]] = generation;
+        }
+        for(int32_t c = 0; c < num_classes; c++){
+            int b = representative[c];
+            int kept = 0;
+            for(int i = 0; i < num_class_states; i++){
+                const nfa_state* st = &ps->states[classes[i]];
+                if(!((ps->sets[st->set][b >> 3] >> (b & 7)) & 1)){
+                    continue;
+                }
+                for(int f = follow_offset[i]; f < follow_offset[i + 1]; f++){
+                    if(member[follow[f]] == generation){
+                        list[kept++] = classes[i];
+                        break;
+                    }
+                }
+            }
+            list[kept++] = match_state;
+            int32_t target = add_subset(&sub, list, kept);
+            if(target < 0){
+                status = (target == -2) ? -1 : 0;
+                break;
+            }
+            next[(size_t)d * num_classes + c] = target;
+        }
+    }
+    if(status > 0){
+        for(int32_t c = 0; c < num_classes; c++){
+            next[c] = 0; //never reached, the match state is in every set
+        }
+        //a set accepts when a match can start right in front of it
+        memset(sub.accept, 0, sub.count);
+        for(int32_t d = 1; d < sub.count; d++){
+            for(int i = sub.offset[d]; i < sub.offset[d + 1]; i++){
+                if(starting[sub.store[i]]){
+                    sub.accept[d] = 1;
+                    break;
+                }
+            }
+        }
+        status = sub.count;
+        *rev_next = next;
+        *rev_accept = sub.accept;
+    }else{
+        free(next);
+        free(sub.accept);
+    }
+    subset_free(&sub);
+    free(classes);
+    free(follow_offset);
+    free(follow);
+    free(mark);
+    free(member);
+    free(stack);
+    free(list);
+    free(starting);
+    return status;
+}
+
+static int32_t add_subset(subset_table* sub, const int* list, int count){
+    if(count == 0){
+        return 0;
+    }
+    uint32_t hash = 2166136261u; //FNV-1a over the state numbers
+    for(int i = 0; i < count; i++){
+        hash = (hash ^ (uint32_t)list[i]) * 16777619u;
+    }
+    int slot = hash % sub->table_size;
+    while(sub->table[slot] != -1){
+        int32_t d = sub->table[slot];
+        int size = sub->offset[d + 1] - sub->offset[d];
+        if(size == count && memcmp(sub->store + sub->offset[d], list, count * sizeof(int)) == 0){
+            return d;
+        }
+        slot = (slot + 1) % sub->table_size;
+    }
+    if(sub->count == REGEX_MAX_STATES){
+        return -1;
+    }
+    int32_t d = sub->count;
+    if(sub->offset[d] + count > sub->capacity){
+        int capacity = sub->capacity;
+        while(sub->offset[d] + count > capacity){
+            capacity *= 2;
+        }
+        int* grown = (int *)realloc(sub->store, capacity * sizeof(int));
+        if(grown == NULL){
+            return -2;
+        }
+        sub->store = grown;
+        sub->capacity = capacity;
+    }
+    memcpy(sub->store + sub->offset[d], list, count * sizeof(int));
+    sub->offset[d + 1] = sub->offset[d] + count;
+    for(int i = 0; i < count; i++){
+        if(sub->states[list[i]].type == NFA_MATCH){
+            sub->accept[d] = 1;
+        }
+    }
+    sub->table[slot] = d;
+    sub->count++;
+    return d;
+}
+
+static int compare_int(const void* a, const void* b){
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static size_t block_layout(int32_t num_states, int32_t num_classes,
+                           int32_t prefix_length, int32_t rev_states){
+    return REGEX_HEADER * sizeof(int32_t) + 256 + 256 + 256 +
+           ((size_t)num_states + rev_states) * num_classes * sizeof(int32_t) +
+           num_states + rev_states + prefix_length;
+}
+
+static void point_arrays(regex_dfa* re){
+    char* cur = re->block + REGEX_HEADER * sizeof(int32_t);
+    re->byte_class = (const unsigned char *)cur;
+    cur += 256;
+    re->first_byte = (const unsigned char *)cur;
+    cur += 256;
+    re->last_byte = (const unsigned char *)cur;
+    cur += 256;
+    re->next = (const int32_t *)cur;
+    cur += (size_t)re->num_states * re->num_classes * sizeof(int32_t);
+    re->rev_next = (const int32_t *)cur;
+    cur += (size_t)re->rev_states * re->num_classes * sizeof(int32_t);
+    re->accept = (const unsigned char *)cur;
+    cur += re->num_states;
+    re->rev_accept = (const unsigned char *)cur;
+    cur += re->rev_states;
+    re->prefix = (const unsigned char *)cur;
+}
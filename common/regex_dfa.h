@@ -0,0 +1,145 @@
+/******************************************************************************
+Title : regex_dfa.h
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Regular expressions compiled to a DFA. The expression is parsed
+into a Thompson NFA which is then turned into a DFA by subset construction
+over the byte classes the expression distinguishes. Like the Aho-Corasick
+automaton the whole DFA lives in one block so it can be compiled on the root
+and broadcast. A match is reported at every position where some string of
+the language starts.
+
+Every position is decided in one pass over the text, whatever the length of
+the matches. Next to the DFA the compiler builds a reverse one whose state
+at a position is the set of NFA states from which some match ending at or
+after that position can be read. The scan runs it once from the end of the
+text to the front, a match starts wherever that set holds the start of the
+expression. When the input goes on past the text the scan also runs an open
+state that assumes any NFA state may still finish after the text, and the
+positions only the open state accepts are left undecided. Once the two states
+agree every position before is decided, so the undecided positions form one
+region the caller scans again with more of the input after it. When the
+reverse DFA would grow past REGEX_MAX_STATES the scan falls back to running
+the DFA from every candidate start.
+
+Supported syntax: literal bytes, . (any byte but newline), [...] and [^...]
+classes with ranges, \d \w \s \D \W \S, \n \t and escaped metacharacters,
+grouping ( ), alternation |, and the repetitions * + ? {m} {m,} {m,n}.
+With REGEX_IGNORE_CASE every byte set holds both cases of its letters, a
+negated class is negated after that so [^a] matches neither a nor A.
+
+To keep the scan close to the speed of a literal search the reverse pass
+skips with memrchr to the only byte that can end a match while no match is
+open. Otherwise, when every match starts with a literal prefix, the literal
+matcher of match.h finds its occurences and only the bytes right after each
+one are run, from a window wide enough for the exact and the open state to
+agree. Otherwise it skips the bytes that can not end a match. The fallback
+jumps between the occurences of the prefix in the same way, or skips bytes
+that can not start a match.
+
+Build with: compile regex_dfa.c and match.c along with the program using it
+******************************************************************************/
+#ifndef REGEX_DFA_H
+#define REGEX_DFA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "match.h"
+
+#define REGEX_MAX_STATES 20000 //largest DFA the compiler builds
+#define REGEX_MAX_REPEAT 1000 //largest bound of a {m,n} repetition
+#define REGEX_IGNORE_CASE 1 //flag of regex_compile, ASCII letters match either case
+
+typedef struct regex_dfa{
+    int32_t num_states; //number of DFA states, state 0 is dead
+    int32_t num_classes; //number of byte classes in the alphabet
+    int32_t start; //start state
+    int32_t after_prefix; //state reached from start by reading the prefix
+    int32_t prefix_length; //length of the literal prefix of every match
+    const unsigned char* byte_class; //byte -> class, 256 entries
+    const int32_t* next; //num_states * num_classes transitions
+    const unsigned char* accept; //1 for states that end a match
+    const unsigned char* first_byte; //1 for bytes that can start a match
+    const unsigned char* prefix; //literal prefix of every match
+    int32_t rev_states; //number of reverse DFA states, 0 when it was too large
+    int32_t rev_start; //reverse state of a text ending the input, no match open
+    int32_t rev_open; //reverse state assuming every NFA state may still finish
+    int32_t last_only; //the only byte that can end a match, -1 if there are more
+    const int32_t* rev_next; //rev_states * num_classes transitions
+    const unsigned char* rev_accept; //1 for reverse states where a match starts
+    const unsigned char* last_byte; //1 for bytes that can end a match
+    matcher prefix_matcher; //matcher of the prefix, when there is one
+    char* block; //single allocation holding all arrays above
+    size_t block_size; //size of block in bytes
+} regex_dfa;
+
+typedef void (*regex_report)(size_t position, void* arg);
+/**
+ * @param: size_t position where a match starts, void pointer handed to
+ *         regex_scan
+ *
+ * @brief: called once for every position a match starts at, in order
+ *
+*/
+typedef void (*regex_pending)(size_t first, void* arg);
+/**
+ * @param: size_t first position whose outcome depends on bytes past the
+ *         text, void pointer handed to regex_scan
+ *
+ * @brief: called at most once, when the text is not the end of the input.
+ * No match at first or after it was reported, the caller scans the text
+ * from first again with more of the input after it
+ *
+*/
+
+int regex_compile(regex_dfa* re, const char* pattern, size_t length,
+                  int flags, char* error, size_t error_size);
+/**
+ * @param: DFA to build, expression, length of the expression, 0 or
+ *         REGEX_IGNORE_CASE, buffer for an error message and its size
+ *
+ * @brief: parses the expression and builds its DFA, the reverse DFA, the
+ * literal prefix and the tables of bytes that can start and end a match
+ *
+ * @return: 0 on success, -1 with a message in error if the expression is
+ * invalid, the DFA grows past REGEX_MAX_STATES or memory ran out
+ *
+*/
+
+int regex_attach(regex_dfa* re, char* block, size_t block_size);
+/**
+ * @param: DFA to fill in, block produced by regex_compile, size of block
+ *
+ * @brief: points the DFA arrays into the block, the DFA takes ownership of
+ * the block and releases it in regex_free
+ *
+ * @return: 0 on success, -1 if the block is not a valid DFA
+ *
+*/
+
+size_t regex_scan(const regex_dfa* re, const char* text, size_t text_length,
+                  size_t starts, int at_end, regex_report report,
+                  regex_pending pending, void* arg);
+/**
+ * @param: DFA, text, length of the text, number of starting positions owned
+ *         by the caller, 1 if the text ends where the input ends, report and
+ *         pending callbacks and their argument
+ *
+ * @brief: reports every position p < starts where a match starts, in
+ * order. A match may run past the text, when at_end is 0 the positions
+ * whose outcome needs bytes past the text go to the pending callback
+ *
+ * @return: number of matches reported
+ *
+*/
+
+void regex_free(regex_dfa* re);
+/**
+ * @param: DFA to release
+ *
+ * @brief: frees the block and the prefix matcher
+ *
+*/
+
+#endif
@@ -0,0 +1,41 @@
+/******************************************************************************
+Title : varint.c
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Implementation of the variable length integers described in
+varint.h.
+
+Build with: compile varint.c along with the program using it
+******************************************************************************/
+#include "varint.h"
+
+size_t varint_encode(uint64_t value, unsigned char* out){
+    size_t n = 0; //bytes written
+    while(value >= 0x80){
+        out[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (unsigned char)value;
+    return n;
+}
+
+size_t varint_decode(const unsigned char* in, const unsigned char* end, uint64_t* value){
+    uint64_t result = 0;
+    for(size_t n = 0; n < VARINT_MAX_BYTES && in + n < end; n++){
+        result |= (uint64_t)(in[n] & 0x7f) << (7 * n);
+        if((in[n] & 0x80) == 0){
+            *value = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+uint64_t zigzag_encode(int64_t value){
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+int64_t zigzag_decode(uint64_t value){
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
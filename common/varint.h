@@ -0,0 +1,53 @@
+/******************************************************************************
+Title : varint.h
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : LEB128 style variable length integers used to ship and store
+lists of file offsets compactly. Offsets are written as the difference to
+the previous one, and differences that may be negative go through zigzag
+encoding first, so nearby offsets cost one or two bytes instead of eight.
+
+Build with: compile varint.c along with the program using it
+******************************************************************************/
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define VARINT_MAX_BYTES 10 //bytes needed by the largest 64 bit value
+
+size_t varint_encode(uint64_t value, unsigned char* out);
+/**
+ * @param: uint64_t value, buffer with room for VARINT_MAX_BYTES bytes
+ *
+ * @brief: writes the value 7 bits at a time, low bits first, with the high
+ * bit of each byte set when more bytes follow
+ *
+ * @return: size_t number of bytes written
+ *
+*/
+
+size_t varint_decode(const unsigned char* in, const unsigned char* end, uint64_t* value);
+/**
+ * @param: encoded bytes, end of the encoded bytes, where to store the value
+ *
+ * @brief: reads one value written by varint_encode
+ *
+ * @return: size_t number of bytes read, 0 if the bytes end early or the
+ * value does not fit in 64 bits
+ *
+*/
+
+uint64_t zigzag_encode(int64_t value);
+int64_t zigzag_decode(uint64_t value);
+/**
+ * @param: signed (encode) or zigzag encoded (decode) value
+ *
+ * @brief: maps 0, -1, 1, -2, ... to 0, 1, 2, 3, ... and back so small
+ * negative differences stay small varints
+ *
+*/
+
+#endif
@@ -0,0 +1,210 @@
+/******************************************************************************
+Title : work_pool.c
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Implementation of the work stealing pool described in
+work_pool.h. Deques are guarded by their own mutex, jobs are coarse (a task
+is a block of a file) so a lock per take is cheap next to the task, and the
+pool mutex is only taken to start a job and when a thread ran out of tasks.
+pool_run deals the next job out only once no thread is taking tasks any
+more, so a thread that woke up late for a job never runs a task of the next
+one with the function of the old one.
+
+Build with: compile work_pool.c along with the program using it, -lpthread
+******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "work_pool.h"
+
+typedef struct pool_thread{
+    work_pool* pool; //pool the thread belongs to
+    int id; //index of the thread and of its deque
+} pool_thread;
+
+static void * pool_worker(void * arg);
+/**
+ * @param: void pointer of a malloc'd pool_thread, freed by the thread
+ *
+ * @brief: waits for a job, runs tasks until no deque has any left, reports
+ * how many it ran and waits for the next job
+ *
+*/
+static bool take_task(work_pool* pool, int id, intmax_t* task);
+/**
+ * @param: pool, id of the thread, where to store the task
+ *
+ * @brief: takes the thread's next own task, or steals the first task of
+ * another thread, trying the threads after it in turn
+ *
+ * @return: true if a task was taken, false if every deque is empty
+ *
+*/
+
+int pool_init(work_pool* pool, int num_threads){
+    memset(pool, 0, sizeof(work_pool));
+    pool->num_threads = num_threads;
+    pool->threads = (pthread_t *)calloc(num_threads, sizeof(pthread_t));
+    pool->deques = (task_deque *)calloc(num_threads, sizeof(task_deque));
+    if(pool->threads == NULL || pool->deques == NULL){
+        free(pool->threads);
+        free(pool->deques);
+        return -1;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    for(int i = 0; i < num_threads; i++){
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+    }
+    for(int i = 0; i < num_threads; i++){
+        pool_thread* self = (pool_thread *)malloc(sizeof(pool_thread));
+        if(self == NULL){
+            pool->num_threads = i;
+            pool_free(pool);
+            return -1;
+        }
+        self->pool = pool;
+        self->id = i;
+        if(pthread_create(&pool->threads[i], NULL, pool_worker, self) != 0){
+            free(self);
+            pool->num_threads = i;
+            pool_free(pool);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int pool_run(work_pool* pool, intmax_t num_tasks, pool_task task, void* arg){
+    pthread_mutex_lock(&pool->lock);
+    //no thread is taking tasks and none can start before the job is set, so
+    //the deques can be filled without their locks
+    while(pool->active > 0){
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    if(num_tasks <= 0){
+        //nothing to run and nothing stolen in it
+        for(int i = 0; i < pool->num_threads; i++){
+            pool->deques[i].stolen = 0;
+        }
+        pthread_mutex_unlock(&pool->lock);
+        return 0;
+    }
+    for(int i = 0; i < pool->num_threads; i++){
+        task_deque* deque = &pool->deques[i];
+        intmax_t first = (i * num_tasks) / pool->num_threads;
+        intmax_t last = ((i + 1) * num_tasks) / pool->num_threads;
+        if(last - first > deque->capacity){
+            intmax_t* bigger = (intmax_t *)realloc(deque->tasks, (last - first) * sizeof(intmax_t));
+            if(bigger == NULL){
+                pthread_mutex_unlock(&pool->lock);
+                return -1;
+            }
+            deque->tasks = bigger;
+            deque->capacity = last - first;
+        }
+        //the bottom is taken first, so the run goes in backwards
+        for(intmax_t t = first; t < last; t++){
+            deque->tasks[last - 1 - t] = t;
+        }
+        deque->top = 0;
+        deque->bottom = last - first;
+        deque->stolen = 0;
+    }
+
+    pool->task = task;
+    pool->arg = arg;
+    pool->remaining = num_tasks;
+    pool->job++;
+    pthread_cond_broadcast(&pool->start);
+    while(pool->remaining > 0 || pool->active > 0){
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+void pool_free(work_pool* pool){
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for(int i = 0; i < pool->num_threads; i++){
+        pthread_join(pool->threads[i], NULL);
+    }
+    for(int i = 0; i < pool->num_threads; i++){
+        free(pool->deques[i].tasks);
+        pthread_mutex_destroy(&pool->deques[i].lock);
+    }
+    free(pool->threads);
+    free(pool->deques);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    memset(pool, 0, sizeof(work_pool));
+}
+
+static void * pool_worker(void * arg){
+    pool_thread* self = (pool_thread *)arg;
+    work_pool* pool = self->pool;
+    int id = self->id;
+    free(self);
+
+    int seen = 0; //last job this thread worked on
+    for(;;){
+        pthread_mutex_lock(&pool->lock);
+        while(pool->job == seen && !pool->stop){
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if(pool->stop){
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        seen = pool->job;
+        pool->active++;
+        pool_task task = pool->task;
+        void* task_arg = pool->arg;
+        pthread_mutex_unlock(&pool->lock);
+
+        intmax_t ran = 0; //tasks this thread finished in the job
+        intmax_t t;
+        while(take_task(pool, id, &t)){
+            task(t, id, task_arg);
+            ran++;
+        }
+        //the last thread out finished the job, every task was taken
+        pthread_mutex_lock(&pool->lock);
+        pool->remaining -= ran;
+        pool->active--;
+        if(pool->active == 0){
+            pthread_cond_signal(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return NULL;
+}
+
+static bool take_task(work_pool* pool, int id, intmax_t* task){
+    task_deque* own = &pool->deques[id];
+    pthread_mutex_lock(&own->lock);
+    if(own->bottom > own->top){
+        *task = own->tasks[--own->bottom];
+        pthread_mutex_unlock(&own->lock);
+        return true;
+    }
+    pthread_mutex_unlock(&own->lock);
+
+    for(int k = 1; k < pool->num_threads; k++){
+        task_deque* victim = &pool->deques[(id + k) % pool->num_threads];
+        pthread_mutex_lock(&victim->lock);
+        if(victim->bottom > victim->top){
+            *task = victim->tasks[victim->top++];
+            pthread_mutex_unlock(&victim->lock);
+            own->stolen++; //only the owner writes it
+            return true;
+        }
+        pthread_mutex_unlock(&victim->lock);
+    }
+    return false;
+}
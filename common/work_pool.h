@@ -0,0 +1,90 @@
+/******************************************************************************
+Title : work_pool.h
+Author : Anton Ha
+Created on : October 18, 2026
+
+Description : Persistent pool of pthreads with work stealing. The threads are
+created once and wait between jobs, so a program running many jobs, one per
+file for example, does not create threads for each of them. A job is a
+number of tasks, numbered from 0, and one function run for every task.
+The tasks are dealt out in contiguous runs, one run to the deque of each
+thread. A thread takes its own tasks from the bottom of its deque, in order,
+and once its deque is empty it steals from the top of the other threads'
+deques, so threads that finish early help the ones that got the expensive
+tasks instead of waiting for them. Every deque counts the tasks its owner
+stole in the last job, which shows how uneven the tasks of that job were.
+
+Build with: compile work_pool.c along with the program using it, -lpthread
+******************************************************************************/
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+typedef void (*pool_task)(intmax_t task, int thread, void* arg);
+/**
+ * @param: number of the task, id of the thread running it, void pointer
+ *         handed to pool_run
+ *
+ * @brief: runs one task of a job, tasks of a job run in any order and at
+ * the same time on different threads
+ *
+*/
+
+typedef struct task_deque{
+    intmax_t* tasks; //task numbers, owner takes from the bottom, thieves from the top
+    intmax_t top; //index of the next task to steal
+    intmax_t bottom; //index past the owner's next task
+    intmax_t capacity; //number of tasks the array can hold
+    intmax_t stolen; //tasks the owner stole from other deques in the last job
+    pthread_mutex_t lock; //guards top and bottom
+} task_deque;
+
+typedef struct work_pool{
+    int num_threads; //threads of the pool
+    pthread_t* threads; //their ids
+    task_deque* deques; //one deque per thread
+    pool_task task; //function of the current job
+    void* arg; //argument of the current job
+    intmax_t remaining; //tasks of the current job not finished yet
+    int active; //threads taking tasks of the current job
+    int job; //counts the jobs, a new value wakes the threads
+    bool stop; //set by pool_free, the threads return
+    pthread_mutex_t lock; //guards task, arg, remaining, active, job and stop
+    pthread_cond_t start; //signaled on a new job or stop
+    pthread_cond_t done; //signaled when the last thread stopped taking tasks
+} work_pool;
+
+int pool_init(work_pool* pool, int num_threads);
+/**
+ * @param: pool to start, number of threads
+ *
+ * @brief: creates the threads and their deques, the threads wait for jobs
+ *
+ * @return: 0 on success, -1 if memory ran out or a thread can not be created
+ *
+*/
+
+int pool_run(work_pool* pool, intmax_t num_tasks, pool_task task, void* arg);
+/**
+ * @param: started pool, number of tasks, function run for each task and
+ *         its argument
+ *
+ * @brief: deals the tasks out to the deques and waits until every task
+ * finished. Only one job runs at a time, pool_run is called by one thread
+ *
+ * @return: 0 on success, -1 if memory ran out
+ *
+*/
+
+void pool_free(work_pool* pool);
+/**
+ * @param: pool to stop
+ *
+ * @brief: stops and joins the threads and frees the deques
+ *
+*/
+
+#endif
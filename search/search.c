@@ -7,21 +7,101 @@ Description : We are given a pattern and file name in the command line
 arguments that we will check where the pattern occurs in the file, and printing
 the indexes where it occurs. To compute this in parallel, I decided to agglomorate
 the file as fairly among the amount of processors I am using. The ROOT processor
-handles all of the input and outputting, and distributing of the file. With the
-processor's chunk of the file, it would be using a brute force method that will
-check where the pattern occurs and send the results to the root processor. Where
-the root processor will be printing it to the user.
+handles all of the input and outputting, while every processor reads its own
+chunk (plus the pattern length - 1 bytes after it) straight from the file with
+collective MPI-IO, so the root is no longer a bottleneck for I/O. With the
+processor's chunk of the file, it would be using the matcher in common/match.c,
+which picks memchr, a SIMD prefilter, Horspool or Two-Way from the pattern
+length, to check where the pattern occurs and send the results to the root
+processor. Where the root processor will be printing it to the user. With
+--patterns the first argument is a file holding one pattern per line, the root
+builds an Aho-Corasick automaton of all of them (common/aho_corasick.c) and
+broadcasts it once, so every processor finds every pattern in a single pass
+over its chunk and the root prints "<pattern id> <index>" pairs, where the
+pattern id is the 0 based position of the pattern among the non empty lines.
+With --window <bytes> a processor never holds its whole chunk: it walks the
+chunk in windows of that many bytes, carrying the last pattern length - 1
+bytes over to the next window, and reads the next window with a non blocking
+MPI-IO read while it is matching the current one. Memory per processor is
+then two windows no matter how big the file is. Indexes are 64 bit from the
+file size down to the printed results, and each processor sends its results
+to the root as varint encoded differences (common/varint.c), so files past
+2 GB with millions of occurences are neither truncated nor blow the stack.
+By default the root gathers every processor's encoded results in two levels
+(common/collectives.c): the processors of a node copy them into a shared
+memory window of the node and only the node leaders meet the root in one
+MPI_Gatherv, and the root prints them through a fully buffered stdout. The
+options reach every processor in a single broadcast of a struct datatype. With --output
+every processor formats its own results, finds where they go in the output
+file with MPI_Exscan and writes them collectively with MPI-IO, as text or,
+with --binary, as native 64 bit integers (pattern id and index pairs when
+searching a pattern file). --count-only only reduces the number of
+occurences to the root and prints it. Results of a pattern file are ordered
+by index and then by pattern id. With --regex the pattern is a regular
+expression (syntax in common/regex_dfa.h), the root compiles it into a DFA
+and broadcasts it like the automaton, and an index is printed wherever a
+match starts. A match has no length limit, so a processor reads
+REGEX_OVERLAP bytes past its chunk, and the positions whose outcome still
+depends on what follows (one region at the end of what it read) are scanned
+again afterwards with more of the file read after them, twice as much every
+time, until they are decided. --build-index writes a trigram index of the
+file (common/ngram_index.c) where every processor indexes its own chunk as
+one partition, and --index answers a search from it: every processor maps
+the index, intersects the positions of the pattern's trigrams among the
+indexes it owns and only reads the file to verify the few candidates left.
+The index remembers the size and modification time of the file and is
+refused once the file changed. Patterns shorter than a trigram are scanned.
+Chunks are matched by length, so NUL and other binary bytes never end a
+scan. --hex takes the pattern as pairs of hex digits so any byte can be
+searched for, and --ignore-case matches ASCII letters in either case: the
+matcher folds case 16 bytes at a time with SSE2, the automaton and the DFA
+put both cases of a letter in one byte class.
+With --threads <n> the program runs hybrid: one processor per node or
+socket reads its slice of the file once and splits the matching of it among
+n threads pinned to the cpus it may run on, instead of one processor, chunk
+copy and pattern copy per hardware thread. The threads first touch the part
+of the chunk they will match before it is read, so on a NUMA machine its
+pages are placed in the memory next to the thread. Each thread keeps its own
+results and the processor appends them in thread order before the single
+exchange with the root, so the root only hears from one processor per node.
 
 Usage : search
 Build with: 
-mpicc -Wall -g -o search search.c
+mpicc -Wall -g -O2 -pthread -I../common -o search search.c ../common/match.c \
+      ../common/aho_corasick.c ../common/varint.c ../common/regex_dfa.c \
+      ../common/ngram_index.c ../common/collectives.c
+Profile with: add -I../common ../common/mpi_profile.c to the mpicc line, the
+table of MPI and compute time per processor is printed on stderr at the end
 Execute with:
 mpirun --use-hwthread-cpus search <pattern> <file_name> 2> /dev/null
+mpirun --use-hwthread-cpus search --patterns <pattern file> <file_name> 2> /dev/null
+mpirun --use-hwthread-cpus search --regex <expression> <file_name> 2> /dev/null
+mpirun --use-hwthread-cpus search --ignore-case <pattern> <file_name> 2> /dev/null
+mpirun --use-hwthread-cpus search --hex <hex digits> <file_name> 2> /dev/null
+mpirun --use-hwthread-cpus search --build-index <index file> <file_name>
+mpirun --use-hwthread-cpus search --index <index file> <pattern> <file_name> 2> /dev/null
+mpirun --use-hwthread-cpus search --window <bytes> <pattern> <file_name> 2> /dev/null
+mpirun --use-hwthread-cpus search --output <out file> [--binary] <pattern> <file_name>
+mpirun --use-hwthread-cpus search --count-only <pattern> <file_name> 2> /dev/null
+mpirun --map-by ppr:1:socket --bind-to socket search --threads <n> <pattern> <file_name> 2> /dev/null
 Modifications: March 26, 2023 (implemented pattern validation)
+               October 18, 2026 (linear time matcher instead of brute force)
+               October 18, 2026 (multi pattern mode with Aho-Corasick)
+               October 18, 2026 (each processor reads its chunk with MPI-IO)
+               October 18, 2026 (streaming mode with double buffered windows)
+               October 18, 2026 (64 bit indexes and varint encoded results)
+               October 18, 2026 (Gatherv / MPI-IO output and --count-only)
+               October 18, 2026 (regular expressions compiled to a DFA)
+               October 18, 2026 (partitioned trigram index and queries)
+               October 18, 2026 (--ignore-case and --hex binary patterns)
+               October 18, 2026 (hybrid --threads mode with pinned threads)
+               October 18, 2026 (packed option broadcast, gather through nodes)
 ******************************************************************************/
+#define _GNU_SOURCE
 #include <sys/stat.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <math.h>
 #include <fcntl.h>
 #include <string.h>
@@ -29,25 +109,371 @@ Modifications: March 26, 2023 (implemented pattern validation)
 #include <stdlib.h>
 #include <stdbool.h>
 #include <ctype.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
 #include "mpi.h"
+#include "match.h"
+#include "aho_corasick.h"
+#include "varint.h"
+#include "regex_dfa.h"
+#include "ngram_index.h"
+#include "collectives.h"
 
 #define ROOT 0
-long int check_pattern(int* res, int checking, int start_index, 
-                       char* chunk, char* pattern);
+#define RESULT_CAPACITY 1024 //starting capacity of a result list
+#define MAX_WINDOW (INT_MAX / 2) //largest window, reads are counted in int
+#define MAX_MESSAGE (1 << 30) //largest piece of a read or message in bytes
+#define REGEX_OVERLAP 4096 //bytes read past a chunk for regex matches crossing it
+#define STITCH_BLOCK 65536 //bytes first read past undecided regex positions
+#define INDEX_BUILD 1 //index_mode that writes the trigram index of the file
+#define INDEX_QUERY 2 //index_mode that answers the search from the index
+#define MAX_THREADS 1024 //most threads of one processor in --threads mode
+#define USAGE "Usage: %s [--patterns | --regex | --index <index file>] [--ignore-case] [--hex] [--window <bytes> | --threads <n>] [--count-only | --output <file> [--binary]] <pattern | pattern file> <file name>\n       %s --build-index <index file> <file name>"
+
+typedef struct result_list{
+    int64_t* res; //indexes in the file where a pattern occurs
+    int32_t* ids; //id of the pattern at each index, NULL when searching one pattern
+    int64_t valid; //number of indexes stored in res
+    int64_t capacity; //number of indexes res (and ids) can hold
+    int64_t start_index; //index of the chunk in reference to the file
+    int count_only; //1 when only valid is kept, not the indexes
+} result_list;
+
+typedef struct pending_match{
+    int64_t index; //index in the file of the first undecided position
+    int64_t end; //index in the file past the positions the scan checked
+    int64_t resume; //index in the file past the bytes the scan read
+} pending_match;
+
+typedef struct pending_list{
+    pending_match* list; //regex positions undecided at the end of a chunk
+    int64_t count; //number of regions in list
+    int64_t capacity; //number of regions list can hold
+    int64_t offset; //index in the file of the text being scanned
+    int64_t end; //index in the file past the positions being checked
+    int64_t resume; //index in the file right after the text being scanned
+    result_list* results; //where decided matches of the chunk go
+} pending_list;
+
+typedef struct tagged_result{
+    int64_t index; //index in the file
+    int32_t id; //id of the pattern
+} tagged_result;
+
+typedef struct search_thread{
+    int id; //index of the thread in its processor
+    int num_threads; //threads of the processor
+    int cpu; //cpu the thread is pinned to, -1 to leave it unpinned
+    int touch; //1 to only touch the thread's part of the chunk, 0 to match it
+    char* chunk; //chunk of the processor
+    intmax_t chunk_length; //bytes in the chunk, allocated bytes when touching
+    int64_t checking; //number of indexes the processor checks
+    int64_t overlap; //bytes past a slice needed by occurences crossing it
+    result_list results; //occurences starting in the thread's slice
+    matcher* m; //matcher of the pattern, NULL when searching a pattern file
+    ac_automaton* ac; //automaton of the pattern file, NULL otherwise
+} search_thread;
+
+int64_t check_pattern(result_list* results, int64_t checking,
+                      char* chunk, intmax_t chunk_length, matcher* m);
+/**
+ * @param: result list, number of checking, chunk of the file, number of
+ *         bytes in the chunk, prepared matcher of the pattern
+ *
+ * @brief: check_pattern will check if the pattern exist within the first
+ * checking positions of the chunk, we will keep track of the index in
+ * reference to the file of it inside results and keep track of the number of
+ * times it occured, which will be the return val
+ *
+ * @return: int64_t of how many times pattern occured inside the chunk
+ * 
+*/
+int64_t check_patterns(result_list* results, int64_t checking,
+                       char* chunk, intmax_t chunk_length, ac_automaton* ac);
+/**
+ * @param: result list, number of checking, chunk of the file, number of
+ *         bytes in the chunk, automaton of the patterns
+ *
+ * @brief: same as check_pattern for every pattern of the automaton at once,
+ * the id of the pattern is stored next to each index
+ *
+ * @return: int64_t of how many times any pattern occured inside the chunk
+ * 
+*/
+int64_t check_regex(result_list* results, int64_t checking, char* chunk,
+                    intmax_t chunk_length, int at_end, regex_dfa* re,
+                    pending_list* pending);
+/**
+ * @param: result list, number of checking, chunk of the file, number of
+ *         bytes in the chunk, 1 if the chunk ends at the end of the file,
+ *         DFA of the expression, list of undecided candidates
+ *
+ * @brief: same as check_pattern for a regular expression, the positions
+ * whose outcome needs bytes past the chunk are added to the pending list
+ *
+ * @return: int64_t of how many matches were decided inside the chunk
+ * 
+*/
+int64_t resolve_pending(MPI_File in_file, MPI_Offset file_size,
+                        pending_list* pending, result_list* results,
+                        regex_dfa* re);
+/**
+ * @param: opened file, size of the file, list of undecided regions,
+ *         result list, DFA of the expression
+ *
+ * @brief: scans every undecided region again with STITCH_BLOCK bytes read
+ * past where its scan stopped, twice as many every time the region is still
+ * not decided, until the bytes read decide it or reach the end of the file
+ *
+ * @return: int64_t of how many positions of the regions turned out to be
+ * matches
+ * 
+*/
+void record_regex_match(size_t position, void* arg);
+void record_regex_pending(size_t first, void* arg);
+/**
+ * @param: size_t position of the match (first undecided position) in the
+ *         text, pending_list
+ *
+ * @brief: report and pending callbacks of check_regex
+ * 
+*/
+int compare_indexes(const void* a, const void* b);
+/**
+ * @param: two int64_t
+ *
+ * @brief: qsort comparison putting stitched regex matches back in order
+ * 
+*/
+void record_match(size_t position, void* arg);
+void record_pattern_match(int32_t pattern_id, size_t position, void* arg);
+/**
+ * @param: (id of the pattern), size_t position of the occurence in the
+ *         chunk, result_list
+ *
+ * @brief: report callbacks of check_pattern and check_patterns, store the
+ * index of the occurence in reference to the file
+ * 
+*/
+void add_result(result_list* results, int32_t pattern_id, int64_t index);
+/**
+ * @param: result list, id of the pattern, index in the file
+ *
+ * @brief: appends an occurence to the result list, doubling its capacity
+ * when it is full
+ * 
+*/
+void reserve_results(result_list* results, int64_t capacity);
+/**
+ * @param: result list, number of indexes it has to hold
+ *
+ * @brief: grows the result list (and its ids when it has them) to hold at
+ * least capacity indexes
+ * 
+*/
+void touch_chunk(char* chunk, intmax_t allocated, int64_t checking,
+                 int num_threads);
+/**
+ * @param: allocated chunk, its size, number of indexes the processor checks,
+ *         number of threads
+ *
+ * @brief: every pinned thread writes to its slice of the chunk before the
+ * chunk is read, so the first touch places the pages on its NUMA node
+ * 
+*/
+void threaded_search(result_list* results, int64_t checking, char* chunk,
+                     intmax_t chunk_length, int64_t overlap, int num_threads,
+                     matcher* m, ac_automaton* ac);
+/**
+ * @param: result list, number of indexes the processor checks, chunk of the
+ *         file, number of bytes in the chunk, overlap needed past a slice,
+ *         number of threads, matcher of the pattern or automaton of the
+ *         pattern file (the other one is NULL)
+ *
+ * @brief: same as check_pattern / check_patterns with the checked indexes
+ * split in contiguous slices among pinned threads. The results of the
+ * threads are appended to the result list in thread order
+ * 
+*/
+void run_search_threads(search_thread* threads, int num_threads);
+/**
+ * @param: filled in thread descriptions, number of threads
+ *
+ * @brief: pins thread t to the t-th cpu the processor may run on (in
+ * turn), so a thread touching and later matching a slice runs on the same
+ * cpu both times, starts them and joins them
+ * 
+*/
+void * search_slice(void * arg);
+/**
+ * @param: void pointer of the thread's search_thread
+ *
+ * @brief: pins the thread and touches or matches its slice of the chunk
+ * 
+*/
+void stream_chunk(MPI_File in_file, MPI_Offset file_size, intmax_t start,
+                  intmax_t checking, intmax_t overlap, intmax_t window,
+                  result_list* results, matcher* m, ac_automaton* ac,
+                  regex_dfa* re, pending_list* pending);
+/**
+ * @param: opened file, size of the file, index of the chunk in the file,
+ *         number of indexes the processor checks, overlap needed past the
+ *         chunk, size of a window, result list, matcher of the pattern,
+ *         automaton of the pattern file and DFA of the expression (only one
+ *         of them is used), list of undecided regex candidates
+ *
+ * @brief: checks the chunk window by window using two buffers, the next
+ * window is read with MPI_File_iread_at while the current one is checked.
+ * The last overlap - 1 bytes of a window are copied to the front of the next
+ * one so occurences crossing a window are found once
+ * 
+*/
+void encode_results(result_list* results, unsigned char** encoded,
+                    int64_t* encoded_length);
+/**
+ * @param: result list, where to store the encoded bytes and their number
+ *
+ * @brief: writes every index as the zigzag varint of its difference to the
+ * previous index, followed by the varint of its pattern id when there are ids
+ * 
+*/
+void decode_results(result_list* results, unsigned char* encoded,
+                    int64_t encoded_length);
+/**
+ * @param: result list to overwrite, encoded bytes and their number
+ *
+ * @brief: reverses encode_results, the result list grows as needed
+ * 
+*/
+void sort_results(result_list* results);
+/**
+ * @param: result list with pattern ids
+ *
+ * @brief: orders the results of a pattern file by index and then pattern
+ * id, the automaton reports them by where the occurence ends
+ * 
+*/
+int compare_results(const void* a, const void* b);
+/**
+ * @param: two tagged_result
+ *
+ * @brief: qsort comparison of sort_results
+ * 
+*/
+void gather_results(result_list* results, int id, int p);
+/**
+ * @param: result list, int processor's id, int number of processors
+ *
+ * @brief: gathers the encoded results of every processor on the root
+ * through the node leaders and prints them in processor order. When the
+ * encoded results do not fit in an int count they are sent one processor
+ * at a time instead
+ * 
+*/
+void write_results(result_list* results, char* output_name, int binary);
+/**
+ * @param: result list, name of the output file, 1 for binary output
+ *
+ * @brief: formats the results, finds this processor's place in the output
+ * file with MPI_Exscan and writes all processors' results collectively
+ * 
+*/
+void write_bytes_at_all(MPI_File file, MPI_Offset offset, char* buffer,
+                        int64_t length);
+/**
+ * @param: opened file, where to write, bytes to write and their number
+ *
+ * @brief: collective write in whole MAX_MESSAGE pieces and then the rest,
+ * since MPI counts are int
+ * 
+*/
+void write_index(char* chunk, intmax_t chunk_length, int64_t checking,
+                 int64_t start_index, MPI_Offset file_size, char* file_name,
+                 char* index_name, int id, int p);
+/**
+ * @param: chunk of the file, number of bytes in the chunk, number of
+ *         indexes the processor owns, index of the chunk in the file, size
+ *         of the file, name of the file, name of the index file, int
+ *         processor's id, int number of processors
+ *
+ * @brief: every processor indexes the trigrams of its chunk as one
+ * partition, finds where the partition goes with MPI_Exscan and writes it
+ * collectively. The root writes the header with the size and modification
+ * time of the file and the partition table gathered from everyone
+ * 
+*/
+void check_index(char* index_name, char* file_name);
+/**
+ * @param: name of the index file, name of the indexed file
+ *
+ * @brief: makes sure the index can be read and still describes the file,
+ * a file that changed size or modification time since the index was built
+ * is an error instead of silently missed occurences
+ * 
+*/
+void query_index(result_list* results, MPI_File in_file, MPI_Offset file_size,
+                 char* index_name, int64_t checking, char* pattern,
+                 int64_t pattern_length);
+/**
+ * @param: result list, opened file, size of the file, name of the index
+ *         file, number of indexes the processor owns, pattern, its length
+ *
+ * @brief: memory maps the index, gets the candidates among the indexes the
+ * processor owns from the trigram positions and verifies each one against
+ * the file. Candidates close to each other are verified from one read
+ * 
+*/
+int format_int64(char* out, int64_t value);
+/**
+ * @param: buffer with room for 20 characters, value to format
+ *
+ * @brief: writes the decimal digits of a non negative value
+ *
+ * @return: int number of characters written
+ * 
+*/
+char* broadcast_string(char* text, int id);
 /**
- * @param: array of int res, int number of checking, int starting index,
- *         string of its chunk, string of the pattern
+ * @param: string on the root (ignored elsewhere), int processor's id
  *
- * @brief: check_pattern will check if the pattern exist within the chunk,
- * we will keep track of the index in reference to the file of it inside res and
- * keep track of the number of times it occured, which will be the return val
+ * @brief: broadcasts a string from the root, other processors get their
+ * own copy
  *
- * @return: long int of how many times pattern occured inside the chunk
+ * @return: the string on every processor
  * 
 */
-int number_of_char(int id, int file_size, int p);
+void print_results(result_list* results);
 /**
- * @param: int processor's id, int size of file, int number of processors 
+ * @param: result list
+ *
+ * @brief: prints one index per line, preceded by its pattern id when
+ * searching a pattern file
+ * 
+*/
+void send_bytes(unsigned char* buffer, int64_t length, int dest);
+void recv_bytes(unsigned char* buffer, int64_t length, int source);
+/**
+ * @param: buffer, number of bytes, rank of the other processor
+ *
+ * @brief: sends (receives) a buffer in pieces of at most MAX_MESSAGE bytes,
+ * since MPI counts are int
+ * 
+*/
+int read_patterns(char* file_name, char*** patterns, size_t** lengths);
+/**
+ * @param: string name of the pattern file, where to store the patterns and
+ *         their lengths
+ *
+ * @brief: reads one pattern per line, keeping only valid ascii characters
+ * like the single pattern mode, and skips lines left empty
+ *
+ * @return: int number of patterns read
+ * 
+*/
+int64_t number_of_char(int id, int64_t file_size, int p);
+/**
+ * @param: int processor's id, size of file, int number of processors 
  *
  * @brief: Using the formula, we properly calculate how many processor {id} will check
  * in its chunk to ensure we distribute the file as fairly among the processors
@@ -68,32 +494,142 @@ int main(int argc, char *argv[]){
     int p;              // number of processes
 
     char* pattern = NULL;  // pattern of the execution
-    intmax_t pattern_length; //length of the pattern
+    int64_t pattern_length = 0; //length of the pattern
     char* chunk = NULL; // each processor's unique chunk of the file
+    intmax_t chunk_length = 0; //number of bytes actually in the chunk
+    matcher pattern_matcher; //matcher prepared once for the pattern
+    int multi = 0; //1 when searching every pattern of a pattern file
+    ac_automaton automaton; //automaton of the pattern file
+    int use_regex = 0; //1 when the pattern is a regular expression
+    regex_dfa regex; //DFA of the regular expression
+    pending_list pending; //regex candidates undecided at the end of the chunk
+    int64_t block_size = 0; //size of the automaton (or DFA) block broadcast to all
+    int index_mode = 0; //INDEX_BUILD, INDEX_QUERY or 0 for a plain scan
+    int ignore_case = 0; //1 when letters match regardless of case
+    int hex = 0; //1 when the pattern is given as hex digits, any byte allowed
+    char* index_name = NULL; //trigram index file to build or to query
+    int64_t overlap = 0; //bytes past a chunk needed by occurences crossing it
+    result_list results; //where the occurences of this processor are stored
+    int64_t window = 0; //window size of the streaming mode, 0 when off
+    int count_only = 0; //1 when only the number of occurences is printed
+    int binary = 0; //1 when the output file holds binary indexes
+    char* output_name = NULL; //output file written with MPI-IO, NULL for stdout
+    int arg = 1; //index of the first positional command line argument
+    int num_threads = 1; //matching threads of every processor
 
-    int in_fd; //placeholder to get the size of the file
-    intmax_t file_size; //hold size of file
+    char* file_name = NULL; //name of the file, known by every processor
+    int has_output = 0; //1 when there is an output file
+    MPI_File in_file; //file opened by every processor for its chunk
+    MPI_Offset file_size; //hold size of file
 
-    intmax_t local_check; 
+    int64_t local_check; 
     //the amount the processor is going to check for pattern in the chunk
-    intmax_t start_index; 
+    int64_t start_index; 
     //placeholder to keep each processor's index of the chunk
 
     MPI_Status status; //info about the communication operation of send / recv
 
-    MPI_Init(&argc, &argv); 
+    int provided; //thread support of the MPI library, only main calls MPI
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
     MPI_Comm_rank( MPI_COMM_WORLD, &id );
     MPI_Comm_size (MPI_COMM_WORLD, &p);
 
     if(ROOT == id){
-        //check if valid amount of command line arguments
-        if(3 != argc){
-            char error_message[strlen(argv[0]) + 50]; //for error message
-            sprintf(error_message, "Usage: %s <pattern> <file name>", argv[0]);
+        char error_message[2 * strlen(argv[0]) + strlen(USAGE)]; //for error message
+        sprintf(error_message, USAGE, argv[0], argv[0]);
+        //options come before the pattern and the file name
+        while(arg < argc && 0 == strncmp(argv[arg], "--", 2)){
+            if(0 == strcmp(argv[arg], "--patterns")){
+                multi = 1;
+                arg += 1;
+            }else if(0 == strcmp(argv[arg], "--regex")){
+                use_regex = 1;
+                arg += 1;
+            }else if(0 == strcmp(argv[arg], "--window") && arg + 1 < argc){
+                for(int i = 0; i < strlen(argv[arg + 1]); i++){
+                    if(!isdigit(argv[arg + 1][i])){
+                        print_error("Window has to be a positive number of bytes!");
+                    }
+                }
+                window = atoll(argv[arg + 1]);
+                if(window <= 0 || window > MAX_WINDOW){
+                    print_error("Window has to be a positive number of bytes!");
+                }
+                arg += 2;
+            }else if(0 == strcmp(argv[arg], "--threads") && arg + 1 < argc){
+                for(int i = 0; i < strlen(argv[arg + 1]); i++){
+                    if(!isdigit(argv[arg + 1][i])){
+                        print_error("Threads has to be a positive number!");
+                    }
+                }
+                num_threads = atoi(argv[arg + 1]);
+                if(num_threads <= 0 || num_threads > MAX_THREADS){
+                    print_error("Threads has to be a positive number!");
+                }
+                arg += 2;
+            }else if(0 == strcmp(argv[arg], "--count-only")){
+                count_only = 1;
+                arg += 1;
+            }else if(0 == strcmp(argv[arg], "--output") && arg + 1 < argc){
+                output_name = argv[arg + 1];
+                arg += 2;
+            }else if(0 == strcmp(argv[arg], "--binary")){
+                binary = 1;
+                arg += 1;
+            }else if(0 == strcmp(argv[arg], "--ignore-case")){
+                ignore_case = 1;
+                arg += 1;
+            }else if(0 == strcmp(argv[arg], "--hex")){
+                hex = 1;
+                arg += 1;
+            }else if(0 == strcmp(argv[arg], "--build-index") && arg + 1 < argc){
+                index_mode = INDEX_BUILD;
+                index_name = argv[arg + 1];
+                arg += 2;
+            }else if(0 == strcmp(argv[arg], "--index") && arg + 1 < argc){
+                index_mode = INDEX_QUERY;
+                index_name = argv[arg + 1];
+                arg += 2;
+            }else{
+                print_error(error_message);
+            }
+        }
+        //check if valid amount of command line arguments and options
+        //building an index takes only the file name
+        if((index_mode == INDEX_BUILD ? 1 : 2) != argc - arg ||
+           (binary && output_name == NULL) ||
+           (count_only && output_name != NULL) || (multi && use_regex) ||
+           (index_mode == INDEX_BUILD && (multi || use_regex || window ||
+                                          count_only || output_name != NULL)) ||
+           (index_mode == INDEX_QUERY && (multi || use_regex || window || ignore_case)) ||
+           (hex && (multi || use_regex || index_mode == INDEX_BUILD)) ||
+           (num_threads > 1 && (window || use_regex || index_mode != 0))){
             print_error(error_message);
+        } else if(index_mode == INDEX_BUILD){
+            //every processor reads its chunk plus the rest of its last trigram
+            overlap = NGRAM_LENGTH;
+        } else if(multi){
+            //build the automaton of every pattern in the pattern file
+            char** patterns = NULL;
+            size_t* lengths = NULL;
+            int count = read_patterns(argv[arg], &patterns, &lengths);
+            if(count == 0){
+                print_error("Pattern file has no valid patterns!");
+            }
+            if(ac_build_flags(&automaton, patterns, lengths, count,
+                              ignore_case ? AC_IGNORE_CASE : 0) != 0){
+                print_error("Automaton memory allocation failed!");
+            }
+            for(int i = 0; i < count; i++){
+                free(patterns[i]);
+            }
+            free(patterns);
+            free(lengths);
+            block_size = automaton.block_size;
+            overlap = automaton.max_length;
         } else {
             //set up pattern
-            char *temp = strdup(argv[1]);  // Use strdup to copy string
+            char *temp = strdup(argv[arg]);  // Use strdup to copy string
             if (temp == NULL) {
                 print_error("Pattern memory allocation failed!");
             }
@@ -102,167 +638,269 @@ int main(int argc, char *argv[]){
                 print_error("Pattern memory allocation failed!");
             }
             int c = 0;
-            for(int i = 0; i < strlen(temp); i++){
-                if(temp[i] >= 32 && temp[i] <= 126){
-                    //make sure only valid ascii characters
-                    pattern[c] = temp[i];
+            if(hex){
+                //two hex digits per byte, so NUL and any other byte can be searched
+                size_t digits = strlen(temp);
+                for(size_t i = 0; i < digits; i += 2){
+                    if(i + 1 == digits || !isxdigit(temp[i]) || !isxdigit(temp[i + 1])){
+                        print_error("Hex pattern has to be pairs of hex digits!");
+                    }
+                    char pair[3] = {temp[i], temp[i + 1], '\0'};
+                    pattern[c] = (char)strtol(pair, NULL, 16);
                     c++;
                 }
+            }else{
+                for(int i = 0; i < strlen(temp); i++){
+                    if(temp[i] >= 32 && temp[i] <= 126){
+                        //make sure only valid ascii characters
+                        pattern[c] = temp[i];
+                        c++;
+                    }
+                }
             }
             pattern_length = c;
             pattern[pattern_length] = '\0';
-            
-            //open the file
-            if ( ( in_fd = open ( argv [2] , O_RDONLY ) ) == -1 ) {
-                print_error("Couldn't read the file!");
+            if(pattern_length == 0){
+                print_error("Pattern has no valid characters!");
+            }
+            overlap = pattern_length;
+            if(use_regex){
+                //compile the expression once, the DFA is broadcast as a block
+                char regex_error[128]; //what is wrong with the expression
+                if(regex_compile(&regex, pattern, pattern_length,
+                                 ignore_case ? REGEX_IGNORE_CASE : 0, regex_error,
+                                 sizeof(regex_error)) != 0){
+                    char message[sizeof(regex_error) + 32];
+                    sprintf(message, "Invalid regular expression: %s", regex_error);
+                    print_error(message);
+                }
+                block_size = regex.block_size;
+                overlap = REGEX_OVERLAP;
+            }
+            if(index_mode == INDEX_QUERY){
+                if(pattern_length < NGRAM_LENGTH){
+                    //no trigram to look up, scan the file instead
+                    index_mode = 0;
+                }else{
+                    check_index(index_name, argv[arg + 1]);
+                }
             }
-            file_size = lseek ( in_fd , 0 , SEEK_END ) ;
-            close ( in_fd );
         }
+        file_name = argv[argc - 1]; //the file name always comes last
+        has_output = (output_name != NULL);
+    }
+    //every option in one broadcast of a struct datatype over their addresses
+    coll_param params[] = {
+        {&has_output, 1, MPI_INT}, {&count_only, 1, MPI_INT},
+        {&binary, 1, MPI_INT}, {&index_mode, 1, MPI_INT}, {&multi, 1, MPI_INT},
+        {&use_regex, 1, MPI_INT}, {&ignore_case, 1, MPI_INT},
+        {&num_threads, 1, MPI_INT}, {&pattern_length, 1, MPI_INT64_T},
+        {&overlap, 1, MPI_INT64_T}, {&window, 1, MPI_INT64_T},
+        {&block_size, 1, MPI_INT64_T}
+    };
+    if(coll_bcast_params(params, sizeof(params) / sizeof(params[0]), ROOT,
+                         MPI_COMM_WORLD) != 0){
+        print_error("Parameter memory allocation failed!");
+    }
+    //every processor opens the file (and output file) itself, so it needs the name
+    file_name = broadcast_string(file_name, id);
+    if(has_output){
+        output_name = broadcast_string(output_name, id);
     }
-    MPI_Bcast(&pattern_length , 1 , MPI_INT , ROOT , MPI_COMM_WORLD );
-    MPI_Bcast(&file_size, 1 , MPI_LONG , ROOT , MPI_COMM_WORLD );
+    if(index_mode != 0){
+        index_name = broadcast_string(index_name, id);
+    }
+    if(MPI_File_open(MPI_COMM_WORLD, file_name, MPI_MODE_RDONLY,
+                     MPI_INFO_NULL, &in_file) != MPI_SUCCESS){
+        print_error("Couldn't read the file!");
+    }
+    MPI_File_get_size(in_file, &file_size);
 
-    //find out how much space we need for the chunk, and allocate for pattern
+    //find out how much space we need for the chunk
     local_check = number_of_char( id, file_size, p ); 
     //the number of chars each processor will check
-    if (id != ROOT) {
-        pattern = (char *)malloc(pattern_length + 1 * sizeof(char));
-        if (pattern == NULL) {
-            print_error("Pattern memory allocation failed!");
+    if(window == 0 && index_mode != INDEX_QUERY){
+        chunk = (char *)malloc((local_check + overlap + 1) * sizeof(char));
+        if (chunk == NULL) {
+            print_error("Chunk memory allocation failed!");
+        }
+        if(num_threads > 1){
+            //place every slice next to the thread matching it
+            touch_chunk(chunk, local_check + overlap + 1, local_check, num_threads);
         }
-    }
-    chunk = (char *)malloc((local_check + pattern_length + 1) * sizeof(char));
-    if (chunk == NULL) {
-        print_error("Chunk memory allocation failed!");
     }
 
-    MPI_Bcast(pattern, pattern_length, MPI_CHAR , ROOT , MPI_COMM_WORLD );
-    pattern[pattern_length] = '\0';
-
-    int rec_chunk; //error checking of recieving chunk
-    int rec_starting; //error checking of recieving starting
-    if(ROOT == id){
-
-        intmax_t num_elements = 0; 
-        //num of elements so far read to keep track of indexes
-        FILE *file = fopen(argv[2],"r");
-        //read the file
-
-        //if the min chunk size is less than pattern length,
-        //dont need to check chunk for pattern else store the chunk
-        if(num_elements + pattern_length > file_size){
-            chunk[0] = '\0';
+    if(multi){
+        //the automaton is one block of bytes, broadcast it once
+        if(id != ROOT){
+            char* block = (char *)malloc(block_size);
+            if(block == NULL){
+                print_error("Automaton memory allocation failed!");
+            }
+            MPI_Bcast(block, block_size, MPI_BYTE, ROOT, MPI_COMM_WORLD);
+            if(ac_attach(&automaton, block, block_size) != 0){
+                print_error("Received an invalid automaton!");
+            }
         }else{
-            fread(chunk,sizeof(char), local_check + pattern_length - 1, file);
+            MPI_Bcast(automaton.block, block_size, MPI_BYTE, ROOT, MPI_COMM_WORLD);
         }
-        chunk[local_check + pattern_length - 1] = '\0'; //null terminate chunk
-
-        start_index = num_elements; //starting index of the processor 0's chunk
-        num_elements += local_check;
-        
-        intmax_t i_check;
-        //keep track of processor[i]'s amount of char(s) checking in the chunk
-        int send_starting; //error checking in sending starting
-        int send_chunk; //error checking in sending chunk
-        for(int i = 1; i < p; i++){
-            i_check = number_of_char( i, file_size, p ); 
-            //number of chars the processor will check
-            fseek(file, num_elements, SEEK_SET); 
-            //increment file pointer to the left index of the processor's chunk
-
-            //if the min chunk size is less than pattern length,
-            //dont need to check chunk for pattern else store the chunk
-            char *temp_chunk = (char *)malloc((i_check + pattern_length + 1) * sizeof(char));
-            if (temp_chunk == NULL) {
-                print_error("Chunk memory allocation failed!");
-            }
-            if(num_elements + pattern_length > file_size){
-                temp_chunk[0] = '\0';
-            }else{
-                fread(temp_chunk,sizeof(char), i_check + pattern_length - 1, file);
+    }else if(use_regex){
+        //the DFA is one block of bytes too
+        if(id != ROOT){
+            char* block = (char *)malloc(block_size);
+            if(block == NULL){
+                print_error("Regex memory allocation failed!");
             }
-            temp_chunk[i_check + pattern_length - 1] = '\0'; //null terminate chunk
-
-            send_chunk = MPI_Send(temp_chunk, i_check + pattern_length, 
-                                    MPI_CHAR, i, 1, MPI_COMM_WORLD);
-            if (send_chunk != MPI_SUCCESS){
-                print_error("Error in sending chunk!");
+            MPI_Bcast(block, block_size, MPI_BYTE, ROOT, MPI_COMM_WORLD);
+            if(regex_attach(&regex, block, block_size) != 0){
+                print_error("Received an invalid regex!");
             }
-            //send starting index of the corresponding chunk to processor i
-            send_starting = MPI_Send(&num_elements, 1, 
-                                        MPI_INT, i, 1, MPI_COMM_WORLD);
-            if (send_starting != MPI_SUCCESS){
-                print_error("Error in sending starting index!");
+        }else{
+            MPI_Bcast(regex.block, block_size, MPI_BYTE, ROOT, MPI_COMM_WORLD);
+        }
+        pending.list = NULL;
+        pending.count = 0;
+        pending.capacity = 0;
+    }else if(index_mode != INDEX_BUILD){
+        //allocate for pattern and prepare its matcher
+        if (id != ROOT) {
+            pattern = (char *)malloc(pattern_length + 1 * sizeof(char));
+            if (pattern == NULL) {
+                print_error("Pattern memory allocation failed!");
             }
-            //increment num elements to keep track of elements we are going to check
-            num_elements += i_check;
-            free(temp_chunk);
         }
-        fclose(file); //close file as its not needed anymore
+        MPI_Bcast(pattern, pattern_length, MPI_CHAR , ROOT , MPI_COMM_WORLD );
+        pattern[pattern_length] = '\0';
+        if(matcher_init_flags(&pattern_matcher, pattern, pattern_length,
+                              ignore_case ? MATCH_IGNORE_CASE : 0) != 0){
+            print_error("Matcher memory allocation failed!");
+        }
     }
-    else{
-        //process of recieving its chunk and starting index
-        rec_chunk = MPI_Recv(chunk, (local_check + pattern_length), MPI_CHAR,
-                                     ROOT, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
-        if (rec_chunk != MPI_SUCCESS){
-            print_error("error in receiving chunk");
+
+    start_index = ((int64_t)id * file_size) / p; //index of the chunk in the file
+    if(window == 0 && index_mode != INDEX_QUERY){
+        //every processor reads its own chunk, all reads are collective calls
+        int64_t to_read = local_check + overlap - 1; //chunk plus its overlap
+        if(start_index + to_read > file_size){
+            //the last chunks stop at the end of the file
+            to_read = file_size - start_index;
         }
-        rec_starting = MPI_Recv(&start_index, 1, MPI_INT, ROOT, 
-                                MPI_ANY_TAG, MPI_COMM_WORLD, &status);
-        if (rec_starting != MPI_SUCCESS){
-            print_error("error in receiving starting index");
+        //counts are int, so read whole MAX_MESSAGE pieces and then the rest
+        MPI_Datatype piece; //MAX_MESSAGE bytes
+        MPI_Type_contiguous(MAX_MESSAGE, MPI_CHAR, &piece);
+        MPI_Type_commit(&piece);
+        int64_t pieces = to_read / MAX_MESSAGE;
+        int64_t rest = to_read % MAX_MESSAGE;
+        MPI_Count received; //number of bytes read by each call
+        chunk_length = 0;
+        if(MPI_File_read_at_all(in_file, start_index, chunk, pieces, piece,
+                                &status) != MPI_SUCCESS){
+            print_error("Error in reading chunk!");
+        }
+        MPI_Get_elements_x(&status, MPI_CHAR, &received);
+        chunk_length += received;
+        if(MPI_File_read_at_all(in_file, start_index + pieces * MAX_MESSAGE,
+                                chunk + pieces * MAX_MESSAGE, rest, MPI_CHAR,
+                                &status) != MPI_SUCCESS){
+            print_error("Error in reading chunk!");
+        }
+        MPI_Get_elements_x(&status, MPI_CHAR, &received);
+        chunk_length += received;
+        MPI_Type_free(&piece);
+        chunk[chunk_length] = '\0'; //null terminate chunk
+        if(!use_regex){
+            MPI_File_close(&in_file); //close file as its not needed anymore
         }
     }
-
-    //local_res is the result array of the indexes where pattern occurs in its chunk
-    int local_res[local_check];
-    //valid is the number of valid indexes in the chunk
-    int valid = check_pattern(local_res, local_check, start_index, 
-                              chunk, pattern);
-    int send_valid; //error checking in sending valid
-    int send_local_res; //error checking in sending local_res
-    if (id == ROOT) {
-        //print processor 0's result array
-        for (int j = 0; j < valid; j++) {
-                printf("%i\n", local_res[j]);
+    if(index_mode == INDEX_BUILD){
+        //index the chunk instead of searching it
+        write_index(chunk, chunk_length, local_check, start_index, file_size,
+                    file_name, index_name, id, p);
+        if(id != ROOT){
+            free(file_name);
+            free(index_name);
         }
+        free(chunk);
+        MPI_Finalize();
+        return 0;
+    }
 
-        int recv_valid; //error checking in recieving valid
-        int recv_local_res; //error checking in recieving local res
-        //increment thru the number of processors starting from 1
-        //so processor 0 can print the local_res of each processor
-        for (int i = 1; i < p; i++) {
-            //recieving 'valid' of processor i
-            recv_valid = MPI_Recv(&valid, 1, MPI_INT, i, 1, 
-                                    MPI_COMM_WORLD, &status);
-            if (recv_valid != MPI_SUCCESS){
-                print_error("Error in recieving number of valid indexes in local res!");
-            }
-            //recieving local_res of processor i
-            recv_local_res = MPI_Recv(local_res, valid, MPI_INT, 
-                                      i, 1, MPI_COMM_WORLD, &status);
-            if (recv_local_res != MPI_SUCCESS){
-                print_error("Error in recieving local res array!");
-            }
-            //print the results to the terminal
-            for (int j = 0; j < valid; j++) {
-                printf("%i\n", local_res[j]);
-            }
+    //results holds the indexes where a pattern occurs in its chunk
+    results.res = NULL;
+    results.ids = NULL;
+    results.valid = 0;
+    results.capacity = 0;
+    results.start_index = start_index;
+    results.count_only = count_only;
+    //--count-only never stores an index, only counts them
+    if(!count_only){
+        reserve_results(&results, RESULT_CAPACITY);
+    }
+    if(multi && !count_only){
+        //ids are only kept when searching a pattern file
+        results.ids = (int32_t *)malloc(results.capacity * sizeof(int32_t));
+        if(results.ids == NULL){
+            print_error("Result memory allocation failed!");
         }
+    }
+    if(window != 0){
+        stream_chunk(in_file, file_size, start_index, local_check, overlap, window,
+                     &results, (multi || use_regex) ? NULL : &pattern_matcher,
+                     multi ? &automaton : NULL, use_regex ? &regex : NULL, &pending);
+    }else if(index_mode == INDEX_QUERY){
+        query_index(&results, in_file, file_size, index_name, local_check,
+                    pattern, pattern_length);
+    }else if(num_threads > 1){
+        threaded_search(&results, local_check, chunk, chunk_length, overlap,
+                        num_threads, multi ? NULL : &pattern_matcher,
+                        multi ? &automaton : NULL);
+    }else if(multi){
+        check_patterns(&results, local_check, chunk, chunk_length, &automaton);
+    }else if(use_regex){
+        check_regex(&results, local_check, chunk, chunk_length,
+                    start_index + chunk_length == file_size, &regex, &pending);
     }else{
-        //send processor 0 its valid
-        send_valid = MPI_Send(&valid, 1, MPI_INT, ROOT,
-                              1, MPI_COMM_WORLD);
-        if (send_valid != MPI_SUCCESS){
-            print_error("Error in sending number of valid indexes in local res!");
+        check_pattern(&results, local_check, chunk, chunk_length, &pattern_matcher);
+    }
+    if(use_regex){
+        //finish the matches running past what was read, then restore the order
+        if(resolve_pending(in_file, file_size, &pending, &results, &regex) > 0 &&
+           !count_only){
+            qsort(results.res, results.valid, sizeof(int64_t), compare_indexes);
         }
-        //send processor 0 its local_res
-        send_local_res = MPI_Send(local_res, valid, MPI_INT, 
-                                  ROOT, 1, MPI_COMM_WORLD);
-        if (send_local_res != MPI_SUCCESS){
-            print_error("Error in sending local res array!");
+        free(pending.list);
+    }
+    if(window != 0 || use_regex || index_mode == INDEX_QUERY){
+        MPI_File_close(&in_file); //close file as its not needed anymore
+    }
+    if(multi && !count_only){
+        sort_results(&results);
+    }
+    if(count_only){
+        //only the number of occurences is needed
+        int64_t total = 0;
+        MPI_Reduce(&results.valid, &total, 1, MPI_INT64_T, MPI_SUM, ROOT, MPI_COMM_WORLD);
+        if(id == ROOT){
+            printf("%" PRId64 "\n", total);
         }
+    }else if(has_output){
+        write_results(&results, output_name, binary);
+    }else{
+        gather_results(&results, id, p);
+    }
+    if(multi){
+        ac_free(&automaton);
+    }else if(use_regex){
+        regex_free(&regex);
+    }else{
+        matcher_free(&pattern_matcher);
+    }
+    free(results.res);
+    free(results.ids);
+    if(id != ROOT){
+        free(file_name);
+        free(output_name);
+        free(index_name);
     }
     free(pattern); //free pattern to prevent memory leaks
     free(chunk); //free chunk to prevent memory leaks
@@ -274,32 +912,758 @@ void print_error(char* error_message){
     MPI_Abort(MPI_COMM_WORLD, 1);
 }
 
-int number_of_char(int id, int file_size, int p){
+int64_t number_of_char(int id, int64_t file_size, int p){
     return ( ( ( id + 1 ) * file_size ) / p ) -
            ( ( id * file_size ) / p );
 }
-long int check_pattern(int* res, int checking, int start_index, 
-                       char* chunk, char* pattern){
-    int count; //counter
-    int valid = 0; //number of times pattern occur in chunk
-    for(int i = 0; i < strlen(chunk); i++){
-        count = 0; //keep track of how many times chunk[ptr] == pattern[ptr]
-
-        for(int j = 0; j < strlen(pattern); j++){
-            if(i + j >= strlen(chunk) || pattern[j] != chunk[i + j]){
-                //break if i + j passes out of bounds or chunk[ptr1] != pattern[ptr2]
+int64_t check_pattern(result_list* results, int64_t checking,
+                      char* chunk, intmax_t chunk_length, matcher* m){
+    //only the first checking positions belong to this chunk, the pattern
+    //length - 1 bytes after them are there for occurences crossing the end
+    matcher_scan(m, chunk, chunk_length, checking, record_match, results);
+    return results->valid;
+}
+int64_t check_patterns(result_list* results, int64_t checking,
+                       char* chunk, intmax_t chunk_length, ac_automaton* ac){
+    ac_scan(ac, chunk, chunk_length, checking, record_pattern_match, results);
+    return results->valid;
+}
+int64_t check_regex(result_list* results, int64_t checking, char* chunk,
+                    intmax_t chunk_length, int at_end, regex_dfa* re,
+                    pending_list* pending){
+    //positions decided by bytes past the chunk are scanned again later
+    pending->results = results;
+    pending->offset = results->start_index;
+    pending->end = results->start_index + checking;
+    pending->resume = results->start_index + chunk_length;
+    regex_scan(re, chunk, chunk_length, checking, at_end, record_regex_match,
+               record_regex_pending, pending);
+    return results->valid;
+}
+int64_t resolve_pending(MPI_File in_file, MPI_Offset file_size,
+                        pending_list* pending, result_list* results,
+                        regex_dfa* re){
+    if(pending->count == 0){
+        return 0;
+    }
+    char* text = NULL; //undecided positions and the bytes read past them
+    int64_t capacity = 0; //bytes text can hold
+    int64_t found = 0; //positions that matched
+    pending_list rest; //what a scan of a region still leaves undecided
+    rest.list = NULL;
+    rest.count = 0;
+    rest.capacity = 0;
+    rest.results = results;
+    MPI_Status status;
+    for(int64_t k = 0; k < pending->count; k++){
+        pending_match region = pending->list[k];
+        int64_t ahead = STITCH_BLOCK; //bytes read past where the scan stopped
+        while(1){
+            int64_t read_end = region.resume + ahead;
+            if(read_end > file_size){
+                read_end = file_size;
+            }
+            int64_t length = read_end - region.index;
+            if(length > capacity){
+                capacity = length;
+                free(text);
+                text = (char *)malloc(capacity * sizeof(char));
+                if(text == NULL){
+                    print_error("Regex memory allocation failed!");
+                }
+            }
+            //counts are int, so read in MAX_MESSAGE pieces
+            for(int64_t done = 0; done < length; done += MAX_MESSAGE){
+                int piece = (length - done < MAX_MESSAGE) ? length - done : MAX_MESSAGE;
+                if(MPI_File_read_at(in_file, region.index + done, text + done, piece,
+                                    MPI_CHAR, &status) != MPI_SUCCESS){
+                    print_error("Error in reading chunk!");
+                }
+            }
+            rest.count = 0;
+            rest.offset = region.index;
+            rest.end = region.end;
+            rest.resume = read_end;
+            found += regex_scan(re, text, length, region.end - region.index,
+                                read_end == file_size, record_regex_match,
+                                record_regex_pending, &rest);
+            if(rest.count == 0){
                 break;
             }
-            count ++;
+            //the positions in front of the new undecided one are done
+            region.index = rest.list[0].index;
+            ahead *= 2;
+        }
+    }
+    free(text);
+    free(rest.list);
+    return found;
+}
+void touch_chunk(char* chunk, intmax_t allocated, int64_t checking,
+                 int num_threads){
+    search_thread threads[num_threads];
+    for(int t = 0; t < num_threads; t++){
+        threads[t].touch = 1;
+        threads[t].chunk = chunk;
+        threads[t].chunk_length = allocated;
+        threads[t].checking = checking;
+    }
+    run_search_threads(threads, num_threads);
+}
+void threaded_search(result_list* results, int64_t checking, char* chunk,
+                     intmax_t chunk_length, int64_t overlap, int num_threads,
+                     matcher* m, ac_automaton* ac){
+    search_thread threads[num_threads];
+    for(int t = 0; t < num_threads; t++){
+        int64_t first = (t * checking) / num_threads; //first index of the slice
+        threads[t].touch = 0;
+        threads[t].chunk = chunk;
+        threads[t].chunk_length = chunk_length;
+        threads[t].checking = checking;
+        threads[t].overlap = overlap;
+        threads[t].m = m;
+        threads[t].ac = ac;
+        threads[t].results.res = NULL;
+        threads[t].results.ids = NULL;
+        threads[t].results.valid = 0;
+        threads[t].results.capacity = 0;
+        threads[t].results.start_index = results->start_index + first;
+        threads[t].results.count_only = results->count_only;
+        if(!results->count_only){
+            reserve_results(&threads[t].results, RESULT_CAPACITY);
+        }
+        if(ac != NULL && !results->count_only){
+            threads[t].results.ids = (int32_t *)malloc(RESULT_CAPACITY * sizeof(int32_t));
+            if(threads[t].results.ids == NULL){
+                print_error("Result memory allocation failed!");
+            }
+        }
+    }
+    run_search_threads(threads, num_threads);
+
+    //slices are in file order, so appending keeps the results in order
+    int64_t total = results->valid;
+    for(int t = 0; t < num_threads; t++){
+        total += threads[t].results.valid;
+    }
+    if(!results->count_only){
+        reserve_results(results, total);
+    }
+    for(int t = 0; t < num_threads; t++){
+        result_list* part = &threads[t].results;
+        if(!results->count_only){
+            memcpy(results->res + results->valid, part->res, part->valid * sizeof(int64_t));
+            if(results->ids != NULL){
+                memcpy(results->ids + results->valid, part->ids, part->valid * sizeof(int32_t));
+            }
+        }
+        results->valid += part->valid;
+        free(part->res);
+        free(part->ids);
+    }
+}
+void run_search_threads(search_thread* threads, int num_threads){
+    //cpus the processor may run on, the threads are pinned to them in turn
+    cpu_set_t allowed;
+    int cpus[CPU_SETSIZE];
+    int num_cpus = 0;
+    if(0 == sched_getaffinity(0, sizeof(cpu_set_t), &allowed)){
+        for(int c = 0; c < CPU_SETSIZE; c++){
+            if(CPU_ISSET(c, &allowed)){
+                cpus[num_cpus++] = c;
+            }
+        }
+    }
+    pthread_t ids[num_threads];
+    for(int t = 0; t < num_threads; t++){
+        threads[t].id = t;
+        threads[t].num_threads = num_threads;
+        threads[t].cpu = num_cpus > 0 ? cpus[t % num_cpus] : -1;
+        if(pthread_create(&ids[t], NULL, search_slice, &threads[t]) != 0){
+            print_error("Thread creation failed!");
+        }
+    }
+    for(int t = 0; t < num_threads; t++){
+        pthread_join(ids[t], NULL);
+    }
+}
+void * search_slice(void * arg){
+    search_thread* self = (search_thread *)arg;
+    //pinning is best effort, the slice is matched right on any cpu
+    if(self->cpu >= 0){
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(self->cpu, &cpus);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+    }
+    int64_t first = (self->id * self->checking) / self->num_threads;
+    int64_t last = ((self->id + 1) * self->checking) / self->num_threads;
+    if(self->touch){
+        //the last thread also touches the overlap past the processor's chunk
+        if(self->id == self->num_threads - 1){
+            last = self->chunk_length;
+        }
+        memset(self->chunk + first, 0, last - first);
+        return NULL;
+    }
+    //the slice plus the bytes occurences starting in it can run into
+    intmax_t length = self->chunk_length - first;
+    if(length > last - first + self->overlap - 1){
+        length = last - first + self->overlap - 1;
+    }
+    if(self->ac != NULL){
+        check_patterns(&self->results, last - first, self->chunk + first, length, self->ac);
+    }else{
+        check_pattern(&self->results, last - first, self->chunk + first, length, self->m);
+    }
+    return NULL;
+}
+void record_regex_match(size_t position, void* arg){
+    pending_list* pending = (pending_list*) arg;
+    add_result(pending->results, 0, pending->offset + position);
+}
+void record_regex_pending(size_t first, void* arg){
+    pending_list* pending = (pending_list*) arg;
+    if(pending->count == pending->capacity){
+        pending->capacity = pending->capacity ? 2 * pending->capacity : 64;
+        pending->list = (pending_match *)realloc(pending->list,
+                            pending->capacity * sizeof(pending_match));
+        if(pending->list == NULL){
+            print_error("Regex memory allocation failed!");
+        }
+    }
+    pending_match* region = &pending->list[pending->count++];
+    region->index = pending->offset + first;
+    region->end = pending->end;
+    region->resume = pending->resume;
+}
+int compare_indexes(const void* a, const void* b){
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+void record_match(size_t position, void* arg){
+    result_list* results = (result_list*) arg;
+    //store the index in regards to the file
+    add_result(results, 0, results->start_index + position);
+}
+void record_pattern_match(int32_t pattern_id, size_t position, void* arg){
+    result_list* results = (result_list*) arg;
+    //store the index in regards to the file and which pattern occured
+    add_result(results, pattern_id, results->start_index + position);
+}
+void add_result(result_list* results, int32_t pattern_id, int64_t index){
+    if(results->count_only){
+        results->valid += 1;
+        return;
+    }
+    if(results->valid == results->capacity){
+        reserve_results(results, 2 * results->capacity);
+    }
+    results->res[results->valid] = index;
+    if(results->ids != NULL){
+        results->ids[results->valid] = pattern_id;
+    }
+    results->valid += 1;
+}
+void reserve_results(result_list* results, int64_t capacity){
+    if(capacity <= results->capacity){
+        return;
+    }
+    int64_t* res = (int64_t *)realloc(results->res, capacity * sizeof(int64_t));
+    if(res == NULL){
+        print_error("Result memory allocation failed!");
+    }
+    results->res = res;
+    if(results->ids != NULL){
+        int32_t* ids = (int32_t *)realloc(results->ids, capacity * sizeof(int32_t));
+        if(ids == NULL){
+            print_error("Result memory allocation failed!");
+        }
+        results->ids = ids;
+    }
+    results->capacity = capacity;
+}
+void encode_results(result_list* results, unsigned char** encoded,
+                    int64_t* encoded_length){
+    //worst case every index and id takes the largest varint
+    int64_t per_result = VARINT_MAX_BYTES * (results->ids != NULL ? 2 : 1);
+    *encoded = (unsigned char *)malloc(results->valid * per_result + 1);
+    if(*encoded == NULL){
+        print_error("Result memory allocation failed!");
+    }
+    int64_t previous = 0; //index the next difference is taken from
+    unsigned char* out = *encoded;
+    for(int64_t j = 0; j < results->valid; j++){
+        out += varint_encode(zigzag_encode(results->res[j] - previous), out);
+        previous = results->res[j];
+        if(results->ids != NULL){
+            out += varint_encode(results->ids[j], out);
+        }
+    }
+    *encoded_length = out - *encoded;
+}
+void decode_results(result_list* results, unsigned char* encoded,
+                    int64_t encoded_length){
+    unsigned char* in = encoded;
+    unsigned char* end = encoded + encoded_length;
+    int64_t previous = 0; //index the next difference is added to
+    uint64_t value;
+    size_t used; //bytes used by the current varint
+    results->valid = 0;
+    while(in < end){
+        used = varint_decode(in, end, &value);
+        if(used == 0){
+            print_error("Received corrupted results!");
+        }
+        in += used;
+        previous += zigzag_decode(value);
+        int32_t pattern_id = 0;
+        if(results->ids != NULL){
+            used = varint_decode(in, end, &value);
+            if(used == 0){
+                print_error("Received corrupted results!");
+            }
+            in += used;
+            pattern_id = value;
+        }
+        add_result(results, pattern_id, previous);
+    }
+}
+void sort_results(result_list* results){
+    tagged_result* tagged = (tagged_result *)malloc(results->valid * sizeof(tagged_result) + 1);
+    if(tagged == NULL){
+        print_error("Result memory allocation failed!");
+    }
+    for(int64_t j = 0; j < results->valid; j++){
+        tagged[j].index = results->res[j];
+        tagged[j].id = results->ids[j];
+    }
+    qsort(tagged, results->valid, sizeof(tagged_result), compare_results);
+    for(int64_t j = 0; j < results->valid; j++){
+        results->res[j] = tagged[j].index;
+        results->ids[j] = tagged[j].id;
+    }
+    free(tagged);
+}
+int compare_results(const void* a, const void* b){
+    const tagged_result* x = (const tagged_result *)a;
+    const tagged_result* y = (const tagged_result *)b;
+    if(x->index != y->index){
+        return (x->index < y->index) ? -1 : 1;
+    }
+    return (x->id > y->id) - (x->id < y->id);
+}
+void gather_results(result_list* results, int id, int p){
+    unsigned char* encoded = NULL; //varint encoded results
+    int64_t encoded_length = 0; //number of encoded bytes
+    int64_t* lengths = NULL; //encoded bytes of every processor, on the root
+    int64_t* offsets = NULL; //where they start in gathered, on the root
+    unsigned char* gathered = NULL; //every processor's encoded results
+    coll_node layout; //nodes of the processors and their leaders
+    encode_results(results, &encoded, &encoded_length);
+    if(id == ROOT){
+        //the terminal is not a line at a time consumer, buffer it fully
+        setvbuf(stdout, NULL, _IOFBF, 1 << 20);
+    }
+    if(coll_node_init(&layout, MPI_COMM_WORLD) != 0){
+        print_error("Result memory allocation failed!");
+    }
+    int gathered_status = coll_gatherv_bytes(&layout, encoded, encoded_length,
+                                             &gathered, &lengths, &offsets);
+    coll_node_free(&layout);
+    if(gathered_status == COLL_NO_MEMORY){
+        print_error("Result memory allocation failed!");
+    }
+
+    if(gathered_status == 0){
+        if(id == ROOT){
+            //print the results of each processor in order
+            for(int i = 0; i < p; i++){
+                decode_results(results, gathered + offsets[i], lengths[i]);
+                print_results(results);
+            }
+        }
+    }else{
+        //too much for one gather, recieve the processors one at a time
+        if(id == ROOT){
+            lengths = (int64_t *)malloc(p * sizeof(int64_t));
+            if(lengths == NULL){
+                print_error("Result memory allocation failed!");
+            }
+        }
+        MPI_Gather(&encoded_length, 1, MPI_INT64_T, lengths, 1, MPI_INT64_T,
+                   ROOT, MPI_COMM_WORLD);
+        if(id == ROOT){
+            print_results(results);
+            for(int i = 1; i < p; i++){
+                free(encoded);
+                encoded = (unsigned char *)malloc(lengths[i] + 1);
+                if(encoded == NULL){
+                    print_error("Result memory allocation failed!");
+                }
+                recv_bytes(encoded, lengths[i], i);
+                decode_results(results, encoded, lengths[i]);
+                print_results(results);
+            }
+        }else{
+            send_bytes(encoded, encoded_length, ROOT);
+        }
+    }
+    fflush(stdout);
+    free(encoded);
+    free(gathered);
+    free(lengths);
+    free(offsets);
+}
+void write_results(result_list* results, char* output_name, int binary){
+    //longest line is a pattern id, a space, an index and a newline
+    int64_t per_result = binary ? 2 * sizeof(int64_t) : 11 + 1 + 20 + 1;
+    char* formatted = (char *)malloc(results->valid * per_result + 1);
+    if(formatted == NULL){
+        print_error("Result memory allocation failed!");
+    }
+    char* out = formatted;
+    for(int64_t j = 0; j < results->valid; j++){
+        if(binary){
+            int64_t record[2]; //pattern id (pattern files only) and index
+            int fields = 0;
+            if(results->ids != NULL){
+                record[fields++] = results->ids[j];
+            }
+            record[fields++] = results->res[j];
+            memcpy(out, record, fields * sizeof(int64_t));
+            out += fields * sizeof(int64_t);
+        }else{
+            if(results->ids != NULL){
+                out += format_int64(out, results->ids[j]);
+                *out++ = ' ';
+            }
+            out += format_int64(out, results->res[j]);
+            *out++ = '\n';
+        }
+    }
+    int64_t length = out - formatted; //bytes this processor writes
+    int64_t offset = 0; //where they go in the output file
+    MPI_Exscan(&length, &offset, 1, MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD);
+    int id;
+    MPI_Comm_rank(MPI_COMM_WORLD, &id);
+    if(id == ROOT){
+        //MPI_Exscan leaves the first processor's result undefined
+        offset = 0;
+    }
+
+    MPI_File out_file;
+    if(MPI_File_open(MPI_COMM_WORLD, output_name, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                     MPI_INFO_NULL, &out_file) != MPI_SUCCESS){
+        print_error("Couldn't open the output file!");
+    }
+    MPI_File_set_size(out_file, 0); //drop what an older output left behind
+    write_bytes_at_all(out_file, offset, formatted, length);
+    MPI_File_close(&out_file);
+    free(formatted);
+}
+void write_bytes_at_all(MPI_File file, MPI_Offset offset, char* buffer,
+                        int64_t length){
+    MPI_Datatype piece; //MAX_MESSAGE bytes
+    MPI_Type_contiguous(MAX_MESSAGE, MPI_CHAR, &piece);
+    MPI_Type_commit(&piece);
+    int64_t pieces = length / MAX_MESSAGE;
+    MPI_Status status;
+    if(MPI_File_write_at_all(file, offset, buffer, pieces, piece,
+                             &status) != MPI_SUCCESS ||
+       MPI_File_write_at_all(file, offset + pieces * MAX_MESSAGE,
+                             buffer + pieces * MAX_MESSAGE, length % MAX_MESSAGE,
+                             MPI_CHAR, &status) != MPI_SUCCESS){
+        print_error("Error in writing the output file!");
+    }
+    MPI_Type_free(&piece);
+}
+void write_index(char* chunk, intmax_t chunk_length, int64_t checking,
+                 int64_t start_index, MPI_Offset file_size, char* file_name,
+                 char* index_name, int id, int p){
+    char* block = NULL; //this processor's partition
+    int64_t block_size = 0;
+    if(ngram_build(chunk, chunk_length, checking, &block, &block_size) != 0){
+        print_error("Index memory allocation failed!");
+    }
+    //partitions follow the header in processor order
+    ngram_partition partition;
+    int64_t before = 0; //bytes of the partitions of the processors before
+    MPI_Exscan(&block_size, &before, 1, MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD);
+    if(id == ROOT){
+        //MPI_Exscan leaves the first processor's result undefined
+        before = 0;
+    }
+    partition.start = start_index;
+    partition.length = checking;
+    partition.offset = ngram_header_size(p) + before;
+    partition.size = block_size;
+    char* header = NULL; //header and partition table, root only
+    if(id == ROOT){
+        header = (char *)malloc(ngram_header_size(p));
+        if(header == NULL){
+            print_error("Index memory allocation failed!");
+        }
+    }
+    MPI_Gather(&partition, 4, MPI_INT64_T,
+               id == ROOT ? header + sizeof(ngram_header) : NULL, 4, MPI_INT64_T,
+               ROOT, MPI_COMM_WORLD);
+
+    MPI_File index_file;
+    if(MPI_File_open(MPI_COMM_WORLD, index_name, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                     MPI_INFO_NULL, &index_file) != MPI_SUCCESS){
+        print_error("Couldn't open the index file!");
+    }
+    MPI_File_set_size(index_file, 0); //drop what an older index left behind
+    if(id == ROOT){
+        //the header remembers which version of the file was indexed
+        struct stat info;
+        if(stat(file_name, &info) != 0){
+            print_error("Couldn't read the file!");
+        }
+        ngram_header* h = (ngram_header *)header;
+        memset(h, 0, sizeof(ngram_header));
+        h->magic = NGRAM_MAGIC;
+        h->num_partitions = p;
+        h->file_size = file_size;
+        h->file_mtime = info.st_mtim.tv_sec;
+        h->file_mtime_nsec = info.st_mtim.tv_nsec;
+        MPI_Status status;
+        if(MPI_File_write_at(index_file, 0, header, ngram_header_size(p), MPI_CHAR,
+                             &status) != MPI_SUCCESS){
+            print_error("Error in writing the index file!");
+        }
+        free(header);
+    }
+    write_bytes_at_all(index_file, partition.offset, block, block_size);
+    MPI_File_close(&index_file);
+    free(block);
+}
+void check_index(char* index_name, char* file_name){
+    ngram_index index;
+    if(ngram_open(&index, index_name) != 0){
+        print_error("Couldn't read the index file!");
+    }
+    struct stat info;
+    if(stat(file_name, &info) != 0){
+        print_error("Couldn't read the file!");
+    }
+    if(index.header->file_size != info.st_size ||
+       index.header->file_mtime != info.st_mtim.tv_sec ||
+       index.header->file_mtime_nsec != info.st_mtim.tv_nsec){
+        print_error("The file changed since the index was built, rebuild it with --build-index!");
+    }
+    ngram_close(&index);
+}
+void query_index(result_list* results, MPI_File in_file, MPI_Offset file_size,
+                 char* index_name, int64_t checking, char* pattern,
+                 int64_t pattern_length){
+    ngram_index index;
+    if(ngram_open(&index, index_name) != 0){
+        print_error("Couldn't read the index file!");
+    }
+    int64_t* candidates = NULL;
+    int64_t count = ngram_candidates(&index, pattern, pattern_length,
+                                     results->start_index,
+                                     results->start_index + checking, &candidates);
+    if(count < 0){
+        print_error("The index file is corrupted!");
+    }
+    ngram_close(&index);
+
+    //verify the candidates, reading a block of the file for nearby ones
+    int64_t block_capacity = (pattern_length > STITCH_BLOCK) ? pattern_length : STITCH_BLOCK;
+    char* block = (char *)malloc(block_capacity * sizeof(char));
+    if(block == NULL){
+        print_error("Index memory allocation failed!");
+    }
+    int64_t block_start = 0; //index in the file of block[0]
+    int64_t block_length = 0; //bytes in block
+    MPI_Status status;
+    for(int64_t k = 0; k < count; k++){
+        int64_t candidate = candidates[k];
+        if(candidate + pattern_length > file_size){
+            break;
+        }
+        if(candidate < block_start || candidate + pattern_length > block_start + block_length){
+            block_start = candidate;
+            block_length = file_size - candidate;
+            if(block_length > block_capacity){
+                block_length = block_capacity;
+            }
+            if(MPI_File_read_at(in_file, block_start, block, block_length,
+                                MPI_CHAR, &status) != MPI_SUCCESS){
+                print_error("Error in reading chunk!");
+            }
+        }
+        if(memcmp(block + (candidate - block_start), pattern, pattern_length) == 0){
+            add_result(results, 0, candidate);
+        }
+    }
+    free(block);
+    free(candidates);
+}
+int format_int64(char* out, int64_t value){
+    char digits[20]; //digits in reverse order
+    int n = 0;
+    do{
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    }while(value > 0);
+    for(int i = 0; i < n; i++){
+        out[i] = digits[n - 1 - i];
+    }
+    return n;
+}
+char* broadcast_string(char* text, int id){
+    int length = 0; //length of the string
+    if(id == ROOT){
+        length = strlen(text);
+    }
+    MPI_Bcast(&length, 1, MPI_INT, ROOT, MPI_COMM_WORLD);
+    if(id != ROOT){
+        text = (char *)malloc((length + 1) * sizeof(char));
+        if(text == NULL){
+            print_error("String memory allocation failed!");
+        }
+    }
+    MPI_Bcast(text, length, MPI_CHAR, ROOT, MPI_COMM_WORLD);
+    text[length] = '\0';
+    return text;
+}
+void print_results(result_list* results){
+    for (int64_t j = 0; j < results->valid; j++) {
+        if(results->ids != NULL){
+            printf("%" PRId32 " %" PRId64 "\n", results->ids[j], results->res[j]);
+        }else{
+            printf("%" PRId64 "\n", results->res[j]);
+        }
+    }
+}
+void send_bytes(unsigned char* buffer, int64_t length, int dest){
+    for(int64_t sent = 0; sent < length; sent += MAX_MESSAGE){
+        int piece = (length - sent < MAX_MESSAGE) ? length - sent : MAX_MESSAGE;
+        if(MPI_Send(buffer + sent, piece, MPI_BYTE, dest, 1, MPI_COMM_WORLD) != MPI_SUCCESS){
+            print_error("Error in sending results!");
+        }
+    }
+}
+void recv_bytes(unsigned char* buffer, int64_t length, int source){
+    MPI_Status status;
+    for(int64_t received = 0; received < length; received += MAX_MESSAGE){
+        int piece = (length - received < MAX_MESSAGE) ? length - received : MAX_MESSAGE;
+        if(MPI_Recv(buffer + received, piece, MPI_BYTE, source, 1, MPI_COMM_WORLD,
+                    &status) != MPI_SUCCESS){
+            print_error("Error in recieving results!");
+        }
+    }
+}
+void stream_chunk(MPI_File in_file, MPI_Offset file_size, intmax_t start,
+                  intmax_t checking, intmax_t overlap, intmax_t window,
+                  result_list* results, matcher* m, ac_automaton* ac,
+                  regex_dfa* re, pending_list* pending){
+    intmax_t end = start + checking; //first index past the chunk
+    intmax_t read_end = end + overlap - 1; //first index past the last window
+    if(read_end > file_size){
+        read_end = file_size;
+    }
+    if(checking <= 0 || start >= read_end){
+        return;
+    }
+    char* buffers[2]; //window being checked and window being read
+    for(int b = 0; b < 2; b++){
+        buffers[b] = (char *)malloc((window + overlap - 1) * sizeof(char));
+        if(buffers[b] == NULL){
+            print_error("Window memory allocation failed!");
         }
+    }
+    MPI_Request request; //the read in flight
+    MPI_Status status;
+    int current = 0; //buffer being checked
+    intmax_t offset = start; //index in the file of buffers[current][0]
+    intmax_t next_read = start; //index in the file of the next unread byte
+    intmax_t new_bytes = (window < read_end - next_read) ? window : read_end - next_read;
+    intmax_t length = new_bytes; //bytes in buffers[current]
 
-        if(count == strlen(pattern)){ 
-            //if count == length of pattern, we have found an occurence!
-            res[valid] = start_index; //store the index in regards to the file
-            valid += 1;
+    MPI_File_iread_at(in_file, next_read, buffers[current], new_bytes, MPI_CHAR, &request);
+    next_read += new_bytes;
+    while(1){
+        MPI_Wait(&request, &status);
+        int more = next_read < read_end; //another window follows
+        intmax_t carry = (overlap - 1 < length) ? overlap - 1 : length;
+        if(more){
+            //start reading the next window behind the carried over bytes
+            memcpy(buffers[1 - current], buffers[current] + length - carry, carry);
+            new_bytes = (window < read_end - next_read) ? window : read_end - next_read;
+            MPI_File_iread_at(in_file, next_read, buffers[1 - current] + carry,
+                              new_bytes, MPI_CHAR, &request);
+            next_read += new_bytes;
+        }
+        //the carried over bytes are checked as the start of the next window
+        intmax_t owned_end = more ? offset + length - carry : end;
+        if(owned_end > end){
+            owned_end = end;
         }
-        start_index ++; 
-        //keep the index in the file the same as the loops index of chunk
+        results->start_index = offset;
+        if(ac != NULL){
+            check_patterns(results, owned_end - offset, buffers[current], length, ac);
+        }else if(re != NULL){
+            check_regex(results, owned_end - offset, buffers[current], length,
+                        offset + length == file_size, re, pending);
+        }else{
+            check_pattern(results, owned_end - offset, buffers[current], length, m);
+        }
+        if(!more){
+            break;
+        }
+        offset += length - carry;
+        length = carry + new_bytes;
+        current = 1 - current;
+    }
+    free(buffers[0]);
+    free(buffers[1]);
+}
+int read_patterns(char* file_name, char*** patterns, size_t** lengths){
+    FILE* file = fopen(file_name, "r");
+    if(file == NULL){
+        print_error("Couldn't read the pattern file!");
     }
-    return valid;
-}
\ No newline at end of file
+    int count = 0; //number of patterns kept
+    int capacity = 0; //number of patterns the arrays can hold
+    char* line = NULL; //current line, grown by getline
+    size_t line_capacity = 0;
+    ssize_t line_length;
+    *patterns = NULL;
+    *lengths = NULL;
+    while((line_length = getline(&line, &line_capacity, file)) != -1){
+        int c = 0;
+        for(ssize_t i = 0; i < line_length; i++){
+            if(line[i] >= 32 && line[i] <= 126){
+                //make sure only valid ascii characters
+                line[c] = line[i];
+                c++;
+            }
+        }
+        if(c == 0){
+            continue;
+        }
+        if(count == capacity){
+            capacity = capacity ? 2 * capacity : 64;
+            *patterns = (char **)realloc(*patterns, capacity * sizeof(char*));
+            *lengths = (size_t *)realloc(*lengths, capacity * sizeof(size_t));
+            if(*patterns == NULL || *lengths == NULL){
+                print_error("Pattern memory allocation failed!");
+            }
+        }
+        (*patterns)[count] = strndup(line, c);
+        if((*patterns)[count] == NULL){
+            print_error("Pattern memory allocation failed!");
+        }
+        (*lengths)[count] = c;
+        count++;
+    }
+    free(line);
+    fclose(file);
+    return count;
+}
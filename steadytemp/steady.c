@@ -18,14 +18,63 @@ its own number of rows to compute in the inner grid of the grid, and used an
 all reduction to find the max difference of every point to find when the grid
 has reached a steady state!
 
+A walk only tells which side of the plate it hit, so the steady temperature
+of a point is the four boundary temperatures weighted by the probabilities
+of hitting each side, and those depend on the plate dimensions alone. With
+--cache the program keeps these probabilities on disk, one file per plate
+size in the given directory. The first run for a size estimates them with the
+same walks and row split, converging on the largest change of any
+probability, and every process writes its rows into the file with MPI I/O.
+Every later run for that size memory maps the file and answers with a dot
+product of four probabilities and four temperatures, without any walk.
+
+With --variance each point's new value comes from a sample of walks built to
+vary less than single walks. antithetic pairs every walk with its mirror
+image, taking north for south and east for west at every step, so the pair
+tends to hit opposite sides and their average is steadier. stratified starts
+four walks with a first step north, east, south and west in turn instead of
+a random one. Both samples still average to the plain walk's expected
+temperature. Every process keeps the sums of single walks and of samples
+per point, and the root reports on stderr the effective sample size gain:
+the variance of the mean of that many plain walks over the variance of a
+sample, which is how many times more plain walks give the same accuracy.
+
+With --transient <steps> the program follows the plate in time instead,
+from an inside at 0 degrees to the given number of explicit steps of the
+heat equation, each one moving every inner point by DIFFUSION_NUMBER times
+the sum of its four neighbours minus four times itself, and prints the
+temperature at (x,y) after the last one. Here every process holds a block
+of consecutive rows with HALO_DEPTH rows of its neighbours above and below
+it, so it can take HALO_DEPTH steps between two exchanges, recomputing the
+halo rows that shrink by one each step instead of exchanging every step.
+The steps between exchanges run tile by tile: a tile of TILE_ROWS by
+TILE_COLS points is copied with a halo of as many points as steps into a
+scratch pair that stays in cache, all the steps run there, and only the
+tile itself is stored, so the grid goes through memory once per exchange
+and not once per step. With --snapshot <prefix> the plate is written every
+--snapshot-every steps to <prefix>.<step> as rows * cols native doubles,
+row by row: the rows are copied and written with non blocking MPI-IO while
+the next steps run, and a snapshot is only waited for when the next one
+starts.
+
 Usage : steady
 Build with: 
-mpicc -Wall -g -o steady steady.c
+mpicc -Wall -g -I../common -o steady steady.c ../common/collectives.c
+Profile with: add ../common/mpi_profile.c to the mpicc line, the
+table of MPI and compute time per processor is printed on stderr at the end
 Execute with:
 mpirun --use-hwthread-cpus steady <file name> <point x> <point y> 2> /dev/null
+mpirun --use-hwthread-cpus steady --cache <directory> <file name> <point x> <point y> 2> /dev/null
+mpirun --use-hwthread-cpus steady --variance <antithetic | stratified> <file name> <point x> <point y>
+mpirun --use-hwthread-cpus steady --transient <steps> [--snapshot <prefix>] [--snapshot-every <steps>] <file name> <point x> <point y>
 Modifications: April 14, 2024 (fixed output coordinate mix up)
+               October 18, 2026 (--cache of hitting probabilities per plate size)
+               October 18, 2026 (--variance antithetic and stratified walks)
+               October 18, 2026 (plate broadcast as one struct datatype)
+               October 18, 2026 (--transient time steps with temporal tiling)
 ******************************************************************************/
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <math.h>
@@ -38,6 +87,7 @@ Modifications: April 14, 2024 (fixed output coordinate mix up)
 #include <math.h>
 #include <time.h>
 #include "mpi.h"
+#include "collectives.h"
 
 typedef struct { /* A 2 D Point */
 int x ;
@@ -56,6 +106,24 @@ const point2d South = { 0 , -1};
 # define SOUTH 3
 # define WEST 4
 # define CONVERGENCE_THRESHOLD 0.05
+//threshold on a probability, the temperature threshold for temperatures up to 100
+# define PROBABILITY_THRESHOLD 0.0005
+# define WALK_PLAIN 0 //one random walk per point and sweep
+# define WALK_ANTITHETIC 1 //a walk and its mirror image
+# define WALK_STRATIFIED 2 //four walks, one per first step
+# define HIT_MAGIC 0x3148544948414c50LL //"PLAHITH1", marks a valid cache file
+//alpha * dt / h^2 of a transient step, an explicit step is stable up to 0.25
+# define DIFFUSION_NUMBER 0.2
+# define HALO_DEPTH 8 //rows of a neighbour held, transient steps per exchange
+# define TILE_ROWS 64 //rows of a tile stepped in cache
+# define TILE_COLS 128 //cols of a tile stepped in cache
+
+typedef struct hit_cache_header{
+    int64_t magic; //HIT_MAGIC
+    int64_t rows; //rows of the plate
+    int64_t cols; //cols of the plate
+    int64_t walks; //walks done from every inner point
+} hit_cache_header; //followed by 4 NESW probabilities per inner point, row by row
 
 
 void print_error(char* error_message);
@@ -102,6 +170,81 @@ int number_of_checks(int id, int size, int p);
  * 
  * @return: int number of checks that process will do
 */
+int answer_from_cache(char* cache_name, int rows, int cols, int x, int y,
+                      double boundary_temp[]);
+/**
+ * @param: string name of the cache file, int rows / cols of the plate,
+ * int x / y of the output in the inner grid, array of 4 NESW temperatures
+ * 
+ * @brief: memory maps the cache file and prints the temperature at (x,y)
+ * as the dot product of its hitting probabilities and the temperatures
+ * 
+ * @return: int 0 on success, -1 if there is no valid cache for the plate
+*/
+void build_cache(char* cache_name, int id, int p, int rows, int cols);
+/**
+ * @param: string name of the cache file, int id of the process, int number
+ * of processes, int rows / cols of the plate
+ * 
+ * @brief: estimates the probability of hitting each side from every inner
+ * point with random walks until they are steady, every process writes the
+ * rows it walked from into the cache file and the root writes the header
+ * last
+ * 
+*/
+double reduced_sample(point2d start, int method, double boundary_temp[], int width,
+                      int height, double moments[]);
+/**
+ * @param: point2d the walks start at, int WALK_ANTITHETIC or WALK_STRATIFIED,
+ * array of 4 NESW temperatures, int width / height of the grid, array of the
+ * point's 4 sums (walk temps, their squares, samples, their squares)
+ * 
+ * @brief: walks the sample of the method from the point and adds every walk
+ * and the sample to the point's sums
+ * 
+ * @return: double the sample, average temperature of its walks
+*/
+int walks_per_sample(int method);
+/**
+ * @param: int method of the walks
+ * 
+ * @return: int number of walks in one sample of the method
+*/
+void transient(int id, int p, int rows, int cols, double boundary_temp[], int steps,
+               char* snapshot_prefix, int snapshot_every, int output_x, int output_y);
+/**
+ * @param: int id of the process, int number of processes, int rows / cols of
+ * the plate, array of 4 NESW temperatures, int number of steps, string
+ * prefix of the snapshot files (NULL for none), int steps between snapshots,
+ * int x / y of the output in the inner grid
+ * 
+ * @brief: takes the steps on blocks of rows with deep halos, exchanging
+ * them every HALO_DEPTH steps, writes the snapshots and prints the
+ * temperature at (x,y) after the last step
+ * 
+*/
+void step_tile(double* from, double* to, int cols, int tile_row, int tile_col,
+               int tile_rows, int tile_cols, int first_row, int last_row, int depth,
+               double* scratch);
+/**
+ * @param: local rows the tile reads, local rows it stores into, int cols of
+ * the plate, int local row / col the tile starts at, int rows / cols of the
+ * tile, int local rows of the first and last inner row held, int steps,
+ * scratch of 2 * (TILE_ROWS + 2 * HALO_DEPTH) * (TILE_COLS + 2 * HALO_DEPTH)
+ * 
+ * @brief: copies the tile and depth points around it into the scratch,
+ * takes depth steps there on a region shrinking by a point each step and
+ * stores the tile
+ * 
+*/
+int first_of_block(int id, int size, int p);
+/**
+ * @param: int id of the process, int size of the tasks to distribute, int
+ * number of processes
+ * 
+ * @return: int index of the process's first task when every process takes
+ * number_of_checks consecutive tasks
+*/
 void print_boundary(int x, int y, double boundary_temp[], int height, int width);
 /**
  * @param: int x coordinate, int y coordinate, array of 4 that contains the 
@@ -121,6 +264,14 @@ int main(int argc, char *argv[]){
     point2d current; //intialize current point
     double boundary_temp[4]; //array of NESW temperature
     int output_x, output_y; //coordinates of the output
+    char* cache_dir = NULL; //directory of the hitting probability caches
+    int arg = 1; //index of the file name arg
+    int method = WALK_PLAIN; //walks averaged into a point every sweep
+    bool bad_method = false; //--variance named an unknown method
+    int steps = 0; //transient steps, 0 for the steady state
+    char* snapshot_prefix = NULL; //snapshot files of --transient
+    int snapshot_every = 0; //steps between two snapshots, 0 for the last only
+    bool bad_steps = false; //a step count is not a positive number
     MPI_Status status; //info about the communication operation of send / recv
 
     MPI_Init(&argc, &argv); 
@@ -129,16 +280,54 @@ int main(int argc, char *argv[]){
 
     //seed into random to ensure each processes have it own unique random number
     srand(time(NULL) + id);
+
+    //options come before the file name
+    while(arg + 1 < argc){
+        if(0 == strcmp(argv[arg], "--cache")){
+            cache_dir = argv[arg + 1];
+        }else if(0 == strcmp(argv[arg], "--variance")){
+            if(0 == strcmp(argv[arg + 1], "antithetic")){
+                method = WALK_ANTITHETIC;
+            }else if(0 == strcmp(argv[arg + 1], "stratified")){
+                method = WALK_STRATIFIED;
+            }else{
+                bad_method = true;
+            }
+        }else if(0 == strcmp(argv[arg], "--transient")){
+            steps = atoi(argv[arg + 1]);
+            bad_steps |= (steps <= 0);
+        }else if(0 == strcmp(argv[arg], "--snapshot")){
+            snapshot_prefix = argv[arg + 1];
+        }else if(0 == strcmp(argv[arg], "--snapshot-every")){
+            snapshot_every = atoi(argv[arg + 1]);
+            bad_steps |= (snapshot_every <= 0);
+        }else{
+            break;
+        }
+        arg += 2;
+    }
     
     if(ROOT == id){
         //check if valid amount of command line arguments
-        if(4 != argc){
-            char error_message[strlen(argv[0]) + 50]; //for error message
-            sprintf(error_message, "Usage: %s <file name> <x> <y>", argv[0]);
+        if(arg + 3 != argc){
+            char error_message[strlen(argv[0]) + 160]; //for error message
+            sprintf(error_message, "Usage: %s [--cache <directory>] [--variance <method>] "
+                    "[--transient <steps> [--snapshot <prefix>] [--snapshot-every <steps>]] "
+                    "<file name> <x> <y>", argv[0]);
             print_error(error_message);
+        } else if(bad_method){
+            print_error("variance method has to be antithetic or stratified");
+        } else if(bad_steps){
+            print_error("steps have to be a positive number");
+        } else if(cache_dir != NULL && method != WALK_PLAIN){
+            print_error("--variance can not be used with --cache");
+        } else if(steps > 0 && (cache_dir != NULL || method != WALK_PLAIN)){
+            print_error("--transient can not be used with --cache or --variance");
+        } else if(steps == 0 && (snapshot_prefix != NULL || snapshot_every > 0)){
+            print_error("snapshots need --transient");
         } else {
             //open the file
-            FILE *file = fopen(argv[1],"r");
+            FILE *file = fopen(argv[arg],"r");
             if(file == NULL){
                 print_error("Error opening file!");
             }
@@ -156,15 +345,15 @@ int main(int argc, char *argv[]){
                 print_error("invalid rows / cols number");
             }
             //check if output coordinates are a valid number
-            for(int i = 2; i < 4; i++){
+            for(int i = arg + 1; i < arg + 3; i++){
                 for(int j = 0; j < strlen(argv[i]);j++){
                     if(!isdigit(argv[i][j])){
                         print_error("output coordinates has to be an non negative integer");
                     }
                 }
             }
-            output_x = atoi(argv[2]);
-            output_y = atoi(argv[3]);
+            output_x = atoi(argv[arg + 1]);
+            output_y = atoi(argv[arg + 2]);
             //validate output coordinates
             if(output_x < 0 || output_y < 0 || output_x >= rows || output_y >= cols){
                 print_error("invalid point on the graph");
@@ -179,12 +368,42 @@ int main(int argc, char *argv[]){
             fclose (file);
         }
     }
-    //broadcast dimensios, output coords, and NESW temps
-    MPI_Bcast(&rows, 1, MPI_INT, ROOT, MPI_COMM_WORLD);
-    MPI_Bcast(&cols, 1, MPI_INT, ROOT, MPI_COMM_WORLD);
-    MPI_Bcast(&output_x, 1, MPI_INT, ROOT, MPI_COMM_WORLD);
-    MPI_Bcast(&output_y, 1, MPI_INT, ROOT, MPI_COMM_WORLD);
-    MPI_Bcast(&boundary_temp, 4, MPI_DOUBLE, ROOT, MPI_COMM_WORLD);
+    //broadcast dimensios, output coords, and NESW temps in one go
+    coll_param plate[] = {
+        {&rows, 1, MPI_INT}, {&cols, 1, MPI_INT}, {&output_x, 1, MPI_INT},
+        {&output_y, 1, MPI_INT}, {boundary_temp, 4, MPI_DOUBLE}
+    };
+    if(coll_bcast_params(plate, 5, ROOT, MPI_COMM_WORLD) != 0){
+        print_error("Parameter memory allocation failed!");
+    }
+
+    if(steps > 0){
+        transient(id, p, rows, cols, boundary_temp, steps, snapshot_prefix,
+                  snapshot_every, output_x, output_y);
+        MPI_Finalize();
+        return 0;
+    }
+
+    if(cache_dir != NULL){
+        //one cache file per plate size, any temperatures can use it
+        char cache_name[strlen(cache_dir) + 64]; //name of the cache file
+        sprintf(cache_name, "%s/plate_%dx%d.hit", cache_dir, rows, cols);
+        int cached = 0; //1 if the root answered from the cache
+        if(id == ROOT){
+            cached = (0 == answer_from_cache(cache_name, rows, cols, output_x, output_y,
+                                             boundary_temp));
+        }
+        MPI_Bcast(&cached, 1, MPI_INT, ROOT, MPI_COMM_WORLD);
+        if(!cached){
+            build_cache(cache_name, id, p, rows, cols);
+            if(id == ROOT && 0 != answer_from_cache(cache_name, rows, cols, output_x,
+                                                    output_y, boundary_temp)){
+                print_error("Error in reading the cache file!");
+            }
+        }
+        MPI_Finalize();
+        return 0;
+    }
 
     //compute the process number of rows to check and allocate memory for the rows
     int check = number_of_checks(id, (rows - 2), p); //processes number of rows to check
@@ -209,7 +428,22 @@ int main(int argc, char *argv[]){
             chunk[i][j] = 0.0;
         }
     }
+    //sums of every point for the effective sample size, 4 per point
+    double** moments = NULL;
+    if(method != WALK_PLAIN){
+        moments = (double **)malloc(check * sizeof(double*));
+        if(moments == NULL){
+            print_error("Chunk memory allocation failed!");
+        }
+        for(int i = 0; i < check; i++){
+            moments[i] = (double *)calloc((cols - 2) * 4, sizeof(double));
+            if(moments[i] == NULL){
+                print_error("Chunk memory allocation failed!");
+            }
+        }
+    }
     int count = 0; //number of times we checked every point in the grid
+    double sample; //temperature averaged into the point this sweep
     int c_row = 0; //chunk row index
     int c_col = 0; //chunk col index
     int location; //location of the random walk
@@ -228,14 +462,20 @@ int main(int argc, char *argv[]){
                 //current is the coordinates of this iterations of the inner grid
                 current.x = j;
                 current.y = i;
-                //keep random walking till we hit a boundary
-                while(0 == (location = on_boundary(current, cols, rows))){
-                    current = next_point(current,next_dir());
+                if(method == WALK_PLAIN){
+                    //keep random walking till we hit a boundary
+                    while(0 == (location = on_boundary(current, cols, rows))){
+                        current = next_point(current,next_dir());
+                    }
+                    sample = boundary_temp [ location - 1];
+                }else{
+                    sample = reduced_sample(current, method, boundary_temp, cols, rows,
+                                            &moments[c_row][c_col * 4]);
                 }
                 //store old value
                 oldvalue = chunk[c_row][c_col];
                 //compute new value by averaging in the boundary we hit into the old value
-                chunk[c_row][c_col] = ( oldvalue * count + boundary_temp [ location - 1]) / (count + 1);
+                chunk[c_row][c_col] = ( oldvalue * count + sample) / (count + 1);
                 //the difference of new - old
                 diff = fabs(chunk[c_row][c_col] - oldvalue);
                 //update maxdiff if diff is greater than max diff
@@ -260,6 +500,31 @@ int main(int argc, char *argv[]){
         }
     }
 
+    if(method != WALK_PLAIN){
+        //variance of the mean of k plain walks and of a sample, summed over points
+        int k = walks_per_sample(method);
+        double samples = count + 1; //samples of every point
+        double local_var[2] = {0, 0}, total_var[2];
+        for(int i = 0; i < check; i++){
+            for(int j = 0; j < cols - 2; j++){
+                double* m = &moments[i][j * 4];
+                double walk_mean = m[0] / (samples * k);
+                double sample_mean = m[2] / samples;
+                local_var[0] += (m[1] / (samples * k) - walk_mean * walk_mean) / k;
+                local_var[1] += m[3] / samples - sample_mean * sample_mean;
+            }
+            free(moments[i]);
+        }
+        free(moments);
+        MPI_Reduce(local_var, total_var, 2, MPI_DOUBLE, MPI_SUM, ROOT, MPI_COMM_WORLD);
+        if(id == ROOT){
+            fprintf(stderr, "%s: %d walks per point, effective sample size gain %.2lf\n",
+                    method == WALK_ANTITHETIC ? "antithetic" : "stratified",
+                    (count + 1) * k,
+                    total_var[1] > 0 ? total_var[0] / total_var[1] : 1.0);
+        }
+    }
+
     double output_value; //value to be printed out
     int id_has = (output_x % p); //which process id has the output value
     int output_chunk_row = output_x / p; //which row in the chunk has the output value
@@ -337,6 +602,378 @@ int number_of_checks(int id, int size, int p){
         return every;
     }
 }
+double reduced_sample(point2d start, int method, double boundary_temp[], int width,
+                      int height, double moments[]){
+    int k = walks_per_sample(method);
+    double sum = 0; //temperatures of the sample's walks
+    if(method == WALK_ANTITHETIC){
+        //both walks take the same draws, the second one mirrored
+        point2d walk[2] = {start, start};
+        int location[2] = {0, 0};
+        while(0 == location[0] || 0 == location[1]){
+            point2d direction = next_dir();
+            point2d mirror = {-direction.x, -direction.y};
+            if(0 == location[0]){
+                walk[0] = next_point(walk[0], direction);
+                location[0] = on_boundary(walk[0], width, height);
+            }
+            if(0 == location[1]){
+                walk[1] = next_point(walk[1], mirror);
+                location[1] = on_boundary(walk[1], width, height);
+            }
+        }
+        for(int w = 0; w < 2; w++){
+            sum += boundary_temp[location[w] - 1];
+            moments[0] += boundary_temp[location[w] - 1];
+            moments[1] += boundary_temp[location[w] - 1] * boundary_temp[location[w] - 1];
+        }
+    }else{
+        //one walk per first step, random after it
+        const point2d first[4] = {North, East, South, West};
+        for(int w = 0; w < 4; w++){
+            point2d current = next_point(start, first[w]);
+            int location;
+            while(0 == (location = on_boundary(current, width, height))){
+                current = next_point(current, next_dir());
+            }
+            sum += boundary_temp[location - 1];
+            moments[0] += boundary_temp[location - 1];
+            moments[1] += boundary_temp[location - 1] * boundary_temp[location - 1];
+        }
+    }
+    double sample = sum / k;
+    moments[2] += sample;
+    moments[3] += sample * sample;
+    return sample;
+}
+int walks_per_sample(int method){
+    if(method == WALK_ANTITHETIC) return 2;
+    else if(method == WALK_STRATIFIED) return 4;
+    else return 1;
+}
+int answer_from_cache(char* cache_name, int rows, int cols, int x, int y,
+                      double boundary_temp[]){
+    int fd = open(cache_name, O_RDONLY);
+    if(fd == -1){
+        return -1;
+    }
+    //the size tells a complete cache of this plate from anything else
+    size_t size = sizeof(hit_cache_header) + (size_t)(rows - 2) * (cols - 2) * 4 * sizeof(double);
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (size_t)info.st_size != size){
+        close(fd);
+        return -1;
+    }
+    void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED){
+        return -1;
+    }
+    const hit_cache_header* header = (const hit_cache_header *)map;
+    if(header->magic != HIT_MAGIC || header->rows != rows || header->cols != cols){
+        munmap(map, size);
+        return -1;
+    }
+    //probabilities of the point, in the order of boundary_temp
+    const double* hit = (const double *)(header + 1) + ((size_t)x * (cols - 2) + y) * 4;
+    double value = 0;
+    for(int k = 0; k < 4; k++){
+        value += hit[k] * boundary_temp[k];
+    }
+    printf("%.2lf\n", value);
+    munmap(map, size);
+    return 0;
+}
+void build_cache(char* cache_name, int id, int p, int rows, int cols){
+    int check = number_of_checks(id, (rows - 2), p); //processes number of rows to check
+    int width = (cols - 2) * 4; //probabilities in a row of the inner grid
+    double** hit = (double **)malloc(check * sizeof(double*)); //rows of probabilities
+    if(hit == NULL){
+        print_error("Cache memory allocation failed!");
+    }
+    for(int i = 0; i < check; i++){
+        hit[i] = (double *)calloc(width, sizeof(double));
+        if(hit[i] == NULL){
+            print_error("Cache memory allocation failed!");
+        }
+    }
+    point2d current; //current point of the walk
+    int count = 0; //number of times we walked from every point in the grid
+    int c_row; //chunk row index
+    int location; //location of the random walk
+    double oldvalue;
+    double maxdiff; //max diff of the chunk
+    double diff; //at a point of the difference of new value minus old value
+    double global_max = 0; //max diff of the entire inner grid
+    while( 1 ){
+        maxdiff = 0;
+        c_row = 0;
+        for(int i = id + 1; i < rows - 1; i += p){
+            for(int j = 1; j < cols - 1; j++){
+                current.x = j;
+                current.y = i;
+                while(0 == (location = on_boundary(current, cols, rows))){
+                    current = next_point(current,next_dir());
+                }
+                //average the side we hit into the four probabilities of the point
+                double* point_hit = &hit[c_row][(j - 1) * 4];
+                for(int k = 0; k < 4; k++){
+                    oldvalue = point_hit[k];
+                    point_hit[k] = ( oldvalue * count + (k == location - 1) ) / (count + 1);
+                    diff = fabs(point_hit[k] - oldvalue);
+                    if(diff > maxdiff){
+                        maxdiff = diff;
+                    }
+                }
+            }
+            c_row += 1;
+        }
+        MPI_Allreduce(&maxdiff, &global_max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        if(global_max <= PROBABILITY_THRESHOLD){
+            break;
+        }else{
+            count += 1;
+        }
+    }
+
+    MPI_File cache_file;
+    MPI_Status status;
+    if(MPI_File_open(MPI_COMM_WORLD, cache_name, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                     MPI_INFO_NULL, &cache_file) != MPI_SUCCESS){
+        print_error("Couldn't open the cache file!");
+    }
+    MPI_File_set_size(cache_file, 0); //drop what an older cache left behind
+    c_row = 0;
+    for(int i = id + 1; i < rows - 1; i += p){
+        MPI_Offset offset = sizeof(hit_cache_header) + (MPI_Offset)(i - 1) * width * sizeof(double);
+        if(MPI_File_write_at(cache_file, offset, hit[c_row], width, MPI_DOUBLE,
+                             &status) != MPI_SUCCESS){
+            print_error("Error in writing the cache file!");
+        }
+        c_row += 1;
+    }
+    //a reader only trusts the file once the header is there
+    MPI_Barrier(MPI_COMM_WORLD);
+    if(id == ROOT){
+        hit_cache_header header = {HIT_MAGIC, rows, cols, count + 1};
+        if(MPI_File_write_at(cache_file, 0, &header, sizeof(header), MPI_CHAR,
+                             &status) != MPI_SUCCESS){
+            print_error("Error in writing the cache file!");
+        }
+    }
+    MPI_File_close(&cache_file);
+    for(int i = 0; i < check; i++){
+        free(hit[i]);
+    }
+    free(hit);
+}
+void transient(int id, int p, int rows, int cols, double boundary_temp[], int steps,
+               char* snapshot_prefix, int snapshot_every, int output_x, int output_y){
+    int check = number_of_checks(id, (rows - 2), p); //processes number of rows
+    int first = 1 + first_of_block(id, (rows - 2), p); //plate row of the first one
+    //a halo can not be deeper than the rows of the neighbour sending it
+    int depth = (rows - 2) / p;
+    depth = (depth < 1) ? 1 : (depth > HALO_DEPTH) ? HALO_DEPTH : depth;
+    //processes without rows sit the steps out
+    MPI_Comm active;
+    MPI_Comm_split(MPI_COMM_WORLD, check > 0 ? 0 : MPI_UNDEFINED, id, &active);
+    if(active == MPI_COMM_NULL){
+        return;
+    }
+    int rank, size; //rank among the processes with rows, their number
+    MPI_Comm_rank(active, &rank);
+    MPI_Comm_size(active, &size);
+    int up = (rank == 0) ? MPI_PROC_NULL : rank - 1; //holds the rows above
+    int down = (rank == size - 1) ? MPI_PROC_NULL : rank + 1; //and below
+
+    //local row l is plate row first - depth + l, the block is rows depth to
+    //depth + check - 1, with depth halo rows on both sides
+    int local_rows = check + 2 * depth;
+    size_t grid_size = (size_t)local_rows * cols;
+    double* grid[2]; //the rows at the last step and at the next one
+    grid[0] = (double *)malloc(grid_size * sizeof(double));
+    grid[1] = (double *)malloc(grid_size * sizeof(double));
+    double* scratch = (double *)malloc(2 * (TILE_ROWS + 2 * HALO_DEPTH)
+                                         * (TILE_COLS + 2 * HALO_DEPTH) * sizeof(double));
+    if(grid[0] == NULL || grid[1] == NULL || scratch == NULL){
+        print_error("Chunk memory allocation failed!");
+    }
+    //the inside starts at 0, the boundaries keep their temperatures in both
+    //copies, the same sides on_boundary reports
+    for(int l = 0; l < local_rows; l++){
+        int row = first - depth + l; //plate row
+        for(int j = 0; j < cols; j++){
+            double value = 0;
+            if(j == 0) value = boundary_temp[WEST - 1];
+            else if(j == cols - 1) value = boundary_temp[EAST - 1];
+            else if(row <= 0) value = boundary_temp[NORTH - 1];
+            else if(row >= rows - 1) value = boundary_temp[SOUTH - 1];
+            grid[0][(size_t)l * cols + j] = value;
+            grid[1][(size_t)l * cols + j] = value;
+        }
+    }
+    //local rows of the first and the last inner row of the plate held
+    int first_inner = depth - first + 1;
+    first_inner = (first_inner < 0) ? 0 : first_inner;
+    int last_inner = depth + (rows - 2 - first);
+    last_inner = (last_inner > local_rows - 1) ? local_rows - 1 : last_inner;
+
+    //snapshot rows of this process, the top and bottom ones add the boundary
+    int snap_first = depth - (rank == 0);
+    int snap_rows = check + (rank == 0) + (rank == size - 1);
+    double* snapshot = NULL; //copy of the rows being written
+    MPI_File snapshot_file;
+    MPI_Request snapshot_request = MPI_REQUEST_NULL;
+    if(snapshot_prefix != NULL){
+        snapshot = (double *)malloc((size_t)snap_rows * cols * sizeof(double));
+        if(snapshot == NULL){
+            print_error("Snapshot memory allocation failed!");
+        }
+    }
+    if(snapshot_every == 0){
+        snapshot_every = steps;
+    }
+
+    int current = 0; //index of the grid holding the last step
+    int done = 0; //steps taken
+    while(done < steps){
+        //as many steps as the halo allows, stopping at the next snapshot
+        int next_snapshot = (done / snapshot_every + 1) * snapshot_every;
+        int run = depth;
+        run = (steps - done < run) ? steps - done : run;
+        run = (next_snapshot - done < run) ? next_snapshot - done : run;
+
+        //the top rows of the block go up, the bottom rows of the one above
+        //come into the halo, and the other way around
+        double* from = grid[current];
+        MPI_Sendrecv(from + (size_t)depth * cols, depth * cols, MPI_DOUBLE, up, 0,
+                     from + (size_t)(depth + check) * cols, depth * cols, MPI_DOUBLE, down, 0,
+                     active, MPI_STATUS_IGNORE);
+        MPI_Sendrecv(from + (size_t)check * cols, depth * cols, MPI_DOUBLE, down, 1,
+                     from, depth * cols, MPI_DOUBLE, up, 1, active, MPI_STATUS_IGNORE);
+
+        double* to = grid[1 - current];
+        for(int r = depth; r < depth + check; r += TILE_ROWS){
+            int tile_rows = (depth + check - r < TILE_ROWS) ? depth + check - r : TILE_ROWS;
+            for(int c = 1; c < cols - 1; c += TILE_COLS){
+                int tile_cols = (cols - 1 - c < TILE_COLS) ? cols - 1 - c : TILE_COLS;
+                step_tile(from, to, cols, r, c, tile_rows, tile_cols, first_inner,
+                          last_inner, run, scratch);
+            }
+        }
+        current = 1 - current;
+        done += run;
+
+        if(snapshot != NULL && (done % snapshot_every == 0 || done == steps)){
+            //the last snapshot is written by now, its copy can be reused
+            if(snapshot_request != MPI_REQUEST_NULL){
+                MPI_Wait(&snapshot_request, MPI_STATUS_IGNORE);
+                MPI_File_close(&snapshot_file);
+            }
+            char snapshot_name[strlen(snapshot_prefix) + 16]; //name of the snapshot file
+            sprintf(snapshot_name, "%s.%d", snapshot_prefix, done);
+            if(MPI_File_open(active, snapshot_name, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                             MPI_INFO_NULL, &snapshot_file) != MPI_SUCCESS){
+                print_error("Couldn't open the snapshot file!");
+            }
+            MPI_File_set_size(snapshot_file, 0); //drop what an older snapshot left behind
+            memcpy(snapshot, grid[current] + (size_t)snap_first * cols,
+                   (size_t)snap_rows * cols * sizeof(double));
+            MPI_Offset offset = (MPI_Offset)(first - depth + snap_first) * cols * sizeof(double);
+            if(MPI_File_iwrite_at(snapshot_file, offset, snapshot, snap_rows * cols,
+                                  MPI_DOUBLE, &snapshot_request) != MPI_SUCCESS){
+                print_error("Error in writing the snapshot file!");
+            }
+        }
+    }
+    if(snapshot_request != MPI_REQUEST_NULL){
+        MPI_Wait(&snapshot_request, MPI_STATUS_IGNORE);
+        MPI_File_close(&snapshot_file);
+    }
+
+    //the process holding the output row sends it to the root
+    int output_row = output_x + 1; //plate row of the output
+    int id_has = 0; //which process id has the output value
+    while(output_row >= 1 + first_of_block(id_has, (rows - 2), p)
+                        + number_of_checks(id_has, (rows - 2), p)){
+        id_has++;
+    }
+    double output_value = 0; //value to be printed out
+    if(id == id_has){
+        output_value = grid[current][(size_t)(depth + output_row - first) * cols + output_y + 1];
+    }
+    if(id_has != ROOT){
+        if(id == id_has && MPI_Send(&output_value, 1, MPI_DOUBLE, ROOT, 1, active) != MPI_SUCCESS){
+            print_error("Error in sending output value");
+        }
+        if(id == ROOT && MPI_Recv(&output_value, 1, MPI_DOUBLE, id_has, MPI_ANY_TAG, active,
+                                  MPI_STATUS_IGNORE) != MPI_SUCCESS){
+            print_error("Error in recieving output value");
+        }
+    }
+    if(id == ROOT){
+        printf("%.2lf\n", output_value);
+    }
+    free(grid[0]);
+    free(grid[1]);
+    free(scratch);
+    free(snapshot);
+    MPI_Comm_free(&active);
+}
+void step_tile(double* from, double* to, int cols, int tile_row, int tile_col,
+               int tile_rows, int tile_cols, int first_row, int last_row, int depth,
+               double* scratch){
+    //the tile with depth points around it, cut at the plate's boundaries
+    int row_start = tile_row - depth, row_end = tile_row + tile_rows + depth;
+    int col_start = tile_col - depth, col_end = tile_col + tile_cols + depth;
+    row_start = (row_start < first_row - 1) ? first_row - 1 : row_start;
+    row_end = (row_end > last_row + 2) ? last_row + 2 : row_end;
+    col_start = (col_start < 0) ? 0 : col_start;
+    col_end = (col_end > cols) ? cols : col_end;
+    int width = col_end - col_start; //cols of the scratch
+    int height = row_end - row_start; //rows of the scratch
+    double* a = scratch; //points at the last step
+    double* b = scratch + (size_t)(TILE_ROWS + 2 * HALO_DEPTH) * (TILE_COLS + 2 * HALO_DEPTH);
+    for(int i = 0; i < height; i++){
+        memcpy(a + (size_t)i * width, from + (size_t)(row_start + i) * cols + col_start,
+               width * sizeof(double));
+        memcpy(b + (size_t)i * width, a + (size_t)i * width, width * sizeof(double));
+    }
+    for(int s = 1; s <= depth; s++){
+        //a point is right after step s if its neighbours were after step s - 1,
+        //so the region shrinks by a point per step down to the tile
+        int grow = depth - s;
+        int i_start = (tile_row - grow < first_row) ? first_row : tile_row - grow;
+        int i_end = (tile_row + tile_rows + grow > last_row + 1) ? last_row + 1
+                                                                  : tile_row + tile_rows + grow;
+        int j_start = (tile_col - grow < 1) ? 1 : tile_col - grow;
+        int j_end = (tile_col + tile_cols + grow > cols - 1) ? cols - 1
+                                                              : tile_col + tile_cols + grow;
+        for(int i = i_start - row_start; i < i_end - row_start; i++){
+            double* above = a + (size_t)(i - 1) * width - col_start;
+            double* here = a + (size_t)i * width - col_start;
+            double* below = a + (size_t)(i + 1) * width - col_start;
+            double* next = b + (size_t)i * width - col_start;
+            for(int j = j_start; j < j_end; j++){
+                next[j] = here[j] + DIFFUSION_NUMBER * (above[j] + below[j] + here[j - 1]
+                                                        + here[j + 1] - 4 * here[j]);
+            }
+        }
+        double* swap = a;
+        a = b;
+        b = swap;
+    }
+    for(int i = tile_row; i < tile_row + tile_rows; i++){
+        memcpy(to + (size_t)i * cols + tile_col,
+               a + (size_t)(i - row_start) * width + tile_col - col_start,
+               tile_cols * sizeof(double));
+    }
+}
+int first_of_block(int id, int size, int p){
+    int every = size / p; //every processes has atleast this many tasks
+    int overload = size % p; //remaining tasks that is leftover
+    return id * every + (id < overload ? id : overload);
+}
 void print_boundary(int x, int y, double boundary_temp[], int height, int width){
     //handle edge cases of small grid
     double avg = 0; //handle edge case avg
@@ -7,22 +7,110 @@ Description : We are checking through multi threaded programming if a pattern
 occurs in an input text, and if it does we redact it. To do this in parallel,
 using p threads, I decided to agglomorate the file as fairly among the threads.
 The main thread will handle all command line arguments, reading the input file
-into memory, intializing flag array, and creation of threads. Each thread will
-check if the pattern occurs in the file using brute force method. If there
-is an occurence, to determine if this thread will redact the input text in
-memory is decided by the flag array that will keep track of what thread altered
-what part of the input text. Finally, it creates an output file of the given
-output file name and the main thread write the results into the file. 
+into memory, preparing the matcher of the pattern once and starting a pool of
+threads (common/work_pool.c). The file is split into one range per thread as
+before, which decides the redact char, and every range is cut into blocks of
+about what a cache holds. The pool deals the blocks out to the threads'
+deques and a thread that runs out of blocks steals from the others, so
+ranges thick with occurences do not leave the other threads idle. Each block
+is checked in place on the shared input text with the matcher in
+common/match.c (memchr, a SIMD prefilter, Horspool or Two-Way picked from
+the pattern length), reading the pattern length - 1 bytes past the block,
+so there is no private copy of the text. Every block records where its
+occurences start in its own list, so finding them needs no lock. Once every
+block is checked, the blocks are redacted, cutting an occurence short where
+the next occurence starts. Blocks are in file order, so the next occurence
+always belongs to the same or a later block and the higher thread id still
+wins where occurences overlap, without a flag array or a mutex. Finally, it
+creates an output file of the given output file name and the main thread
+write the results into the file. 
+
+With --dict the pattern argument is a dictionary file holding one pattern per
+line and every pattern is redacted in the same pass: the patterns are built
+into one Aho-Corasick automaton (common/aho_corasick.c) that the threads
+share read only. Occurences may then have different lengths, so where they
+overlap each byte keeps the redact char of the occurence starting last, the
+same rule as for one pattern, and the bytes past where a later block's
+occurences end are still redacted by the block that found them.
+
+With --batch the list file names one input file per line, each is redacted
+to the same name with .redact appended, with the I/O of --mmap. The pool is
+started once for the whole batch and a file that fails is reported without
+stopping the others.
+
+With --mmap the input is memory mapped read only instead of read into memory,
+the main thread copies it to the output file in the kernel with
+copy_file_range (sendfile where that is not supported) and the threads then
+pwrite only the redacted ranges over the copy, so memory grows with the
+number of occurences and not with the file. With --in-place the input is
+mapped shared and writable and the threads redact the file itself, no output
+file is written.
+
+With --stream the input is read from stdin and the redacted text written to
+stdout as it comes, so it works on pipes and input of any length. A reader
+thread reads blocks into a ring of buffers, the threads redact whole blocks
+and a writer thread writes them out in order. The reader holds back the last
+pattern length - 1 bytes it read until more input arrives, and every block
+carries the pattern length - 1 bytes before it and after it, so occurences
+crossing blocks are still redacted. Memory is the ring, whatever the input
+length, and in this mode every occurence is redacted with the first redact
+char because how reads split the input is not up to the program.
+
+Built with -DREDACT_MPI, --mpi redacts one file on many nodes: each
+processor reads its byte range of the file, plus the pattern length - 1
+bytes after it, with collective MPI-IO and redacts it on its own pool of
+threads. The ranges deciding the redact chars are those of a single run
+with number of processors * number of threads threads, processor r holding
+ranges r * threads to (r + 1) * threads - 1, so the output is the same as
+that run. Occurences crossing the end of a processor's range are the only
+thing the processors need from each other: every processor sends those
+spans with their redact char to the others in one MPI_Allgatherv, and a
+processor paints the ones reaching into its range, in order of start,
+before its own occurences, which start later and so still win. Each
+processor then writes its own range of the output file collectively.
+
+Every thread counts the blocks and bytes it checked, the occurences it
+found, the occurences starting inside an earlier one (the overlaps the old
+flag array settled) and the bytes it redacted, in cache lines of its own so
+the counters are never shared between cores. Built with -DREDACT_TIMERS it also
+times with clock_gettime how long it checked and redacted, and how long it
+waited: in --stream on the lock and condition of the ring, otherwise idle at
+the end of the pool's jobs, where the pthread_barrier_wait used to be. The
+counters cost one store per block, the timers two clock reads. --stats
+prints them per thread as JSON on stderr at the end, with how many of the
+blocks every thread checked it stole, and the wall time. --progress <seconds> prints the bytes
+checked so far, the occurences and the rate on stderr at that interval.
 
 Usage : redact
 Build with: 
-gcc redact.c
+gcc -Wall -O2 -I../common -o redact redact.c ../common/match.c ../common/aho_corasick.c ../common/work_pool.c -lpthread
+mpicc -Wall -O2 -DREDACT_MPI -I../common -o redact redact.c ../common/match.c ../common/aho_corasick.c ../common/work_pool.c -lpthread
+add -DREDACT_TIMERS to either line for the times of --stats
 Execute with:
 ./a.out <number of threads> <pattern> <input file> <output file>
+./a.out --mmap <number of threads> <pattern> <input file> <output file>
+./a.out --in-place <number of threads> <pattern> <file>
+./a.out --stream <number of threads> <pattern> < <input> > <output>
+./a.out --batch <number of threads> <pattern> <list file>
+./a.out [mode] --dict <number of threads> <dictionary file> ...
+mpirun -np <nodes> --map-by ppr:1:node ./a.out --mpi <number of threads> <pattern> <input file> <output file>
+./a.out [--stats] [--progress <seconds>] [mode] ...
 Modifications: May 3, 2023 (added comments)
+               October 18, 2026 (thread local match lists instead of a mutex)
+               October 18, 2026 (shared matcher on the text, no chunk copies)
+               October 18, 2026 (--mmap and --in-place modes, output with fwrite)
+               October 18, 2026 (--stream mode over a ring of blocks)
+               October 18, 2026 (work stealing pool over blocks, --batch mode)
+               October 18, 2026 (--dict mode with an Aho-Corasick automaton)
+               October 18, 2026 (--mpi mode over processors with -DREDACT_MPI)
+               October 18, 2026 (per thread counters, --stats and --progress)
 ******************************************************************************/
+#define _GNU_SOURCE //copy_file_range
 #include <sys/stat.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <errno.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <math.h>
@@ -33,38 +121,372 @@ Modifications: May 3, 2023 (added comments)
 #include <stdbool.h>
 #include <ctype.h>
 #include <pthread.h>
+#include <time.h>
+#include "match.h"
+#include "aho_corasick.h"
+#include "work_pool.h"
+#ifdef REDACT_MPI
+#include "mpi.h"
+#endif
+
+#define MATCH_CAPACITY 1024 //starting capacity of a block's match list
+#define FILE_BLOCK (1 << 18) //most bytes in a block of a file, about an L2 cache
+#define FILL_SIZE 4096 //bytes of redact chars written by one pwrite
+#define CACHE_LINE 64 //bytes of a cache line, a thread's counters take two
+
+#define REDACT_MEMORY 0 //read the input into memory, write it with fwrite
+#define REDACT_MMAP 1 //map the input, copy it in the kernel, pwrite the ranges
+#define REDACT_IN_PLACE 2 //map the input shared and redact the file itself
+#define REDACT_STREAM 3 //redact stdin to stdout block by block
+#define REDACT_BATCH 4 //redact every file of a list like --mmap
+#define REDACT_DISTRIBUTED 5 //redact one file on many processors with MPI
+
+#define MAX_MESSAGE (1 << 30) //largest piece of an MPI-IO read or write in bytes
+#ifdef REDACT_MPI
+#define MPI_USAGE "       redact --mpi [--dict] <number of threads> <pattern> <input file> <output file>\n"
+#else
+#define MPI_USAGE ""
+#endif
+
+#define STREAM_BLOCK 65536 //most bytes read into one block of --stream
+#define BLOCK_FREE 0 //block can be filled by the reader
+#define BLOCK_READ 1 //block waits for a thread to redact it
+#define BLOCK_WORKING 2 //a thread is redacting the block
+#define BLOCK_DONE 3 //block waits for the writer
+
+#define OPTIONS_USAGE "       options [--stats] [--progress <seconds>] go before the mode\n"
+
+typedef struct pattern_set{
+    bool dict; //true for a dictionary of patterns
+    matcher single; //matcher of the one pattern
+    ac_automaton automaton; //automaton of the dictionary
+    intmax_t max_length; //length of the longest pattern
+} pattern_set;
+
+typedef struct match_span{
+    intmax_t start; //index where an occurence starts
+    intmax_t end; //index past where it ends
+} match_span;
 
 typedef struct task_data{
     intmax_t first; //start index of checking
     intmax_t last; //last index of checking
-    char* pattern;
-    pthread_t thread_id;
-    int file_size;
-    char* text; //global input file text in memory
-    int* flag; //mentoined below
-    char redact_char; //corresponding redact char
-    int id;
+    pattern_set* patterns; //pattern or dictionary, shared read only
+    pthread_t thread_id; //thread of --stream
+    intmax_t file_size;
+    char* text; //input file text in memory or mapped
+    int out_fd; //output file the ranges are pwritten to, -1 to write the text
+    char redact_char; //redact char of the range the block is in
+    intmax_t id; //index of the block, or of the thread in --stream
+    match_span* matches; //occurences found, ordered by start
+    intmax_t num_matches; //number of indexes in matches
+    intmax_t capacity; //number of indexes matches can hold
 } task_data;
-static char* input_text; //reading the input file into memory
-static int* flag;
-/*
-flag is an array of int that is size of the input file and
-when a pattern occurs in the input text, the thread will
-flag the index with its id, to ensure we keep track of ranks alteration
-*/
 
-pthread_mutex_t update_mutex; //declare global mutex
-pthread_barrier_t barrier; //declare thread barrier
+typedef struct file_job{
+    task_data* blocks; //blocks of the file, in file order
+    intmax_t num_blocks; //number of blocks
+} file_job;
+
+typedef struct boundary_span{
+    int64_t start; //index in the file where the occurence starts
+    int64_t end; //index in the file past where it ends
+    int64_t redact_char; //redact char of the range it starts in
+} boundary_span;
+
+typedef struct stream_block{
+    char* data; //carried bytes, the block, then the bytes after it
+    intmax_t carry; //bytes before the block, from the blocks before
+    intmax_t length; //bytes of the block itself, the ones written out
+    intmax_t lookahead; //bytes after the block, held back for the next block
+    int state; //BLOCK_FREE, BLOCK_READ, BLOCK_WORKING or BLOCK_DONE
+} stream_block;
+
+typedef struct stream_ring{
+    stream_block* blocks; //the ring of buffers
+    int num_blocks; //number of buffers in the ring
+    intmax_t num_read; //blocks the reader handed out so far
+    intmax_t num_taken; //blocks taken by the threads so far
+    intmax_t num_written; //blocks written out so far
+    bool eof; //the reader is done, num_read is the number of blocks
+    pattern_set* patterns; //pattern or dictionary
+    pthread_mutex_t lock; //guards the counters, eof and the block states
+    pthread_cond_t changed; //signaled whenever one of them changes
+} stream_ring;
 
-void * check_pattern(void * thread_data);
+typedef struct thread_stats{
+    intmax_t blocks; //blocks checked
+    intmax_t stolen; //blocks checked that were stolen from other threads
+    intmax_t bytes; //bytes checked
+    intmax_t matches; //occurences found
+    intmax_t overlaps; //occurences starting before an earlier one ended
+    intmax_t redacted; //bytes filled with redact chars
+    double check_time; //seconds checking blocks, with -DREDACT_TIMERS
+    double redact_time; //seconds redacting them
+    double wait_time; //seconds waiting on the ring in --stream
+    char pad[2 * CACHE_LINE - 6 * sizeof(intmax_t) - 3 * sizeof(double)]; //fills the second line
+} thread_stats;
+_Static_assert(sizeof(thread_stats) == 2 * CACHE_LINE, "thread_stats must fill two cache lines");
+
+typedef struct progress_state{
+    double interval; //seconds between two reports, 0 when off
+    intmax_t total; //bytes of the files started so far, 0 in --stream
+    bool stop; //set once the work is done
+    pthread_t thread_id; //thread printing the reports
+    pthread_mutex_t lock; //guards stop
+    pthread_cond_t stopped; //signaled when stop is set
+} progress_state;
+
+static stream_ring ring; //blocks of --stream
+static thread_stats* stats; //counters of every thread, two cache lines each
+static int num_stats; //number of threads with counters
+static double pool_time; //seconds the pool ran jobs, with -DREDACT_TIMERS
+static progress_state progress; //--progress reporter
+//redact string of thread where its corresponding char will be id % 64
+static char* redact_string = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_ ";
+
+int redact_file(work_pool* pool, int mode, int num_ranges, pattern_set* patterns,
+                const char* input_name, const char* output_name);
+/**
+ * @param: started pool, REDACT_MEMORY, REDACT_MMAP or REDACT_IN_PLACE,
+ *         number of ranges deciding the redact chars, pattern or
+ *         dictionary, input file name, output file name (NULL in place)
+ *
+ * @brief: reads or maps the file, cuts it into blocks, has the pool check
+ * every block and then redact every block, and writes the result
+ *
+ * @return: 0 on success, -1 if the file could not be read or written
+ * 
+*/
+int redact_batch(work_pool* pool, int num_ranges, pattern_set* patterns,
+                 const char* list_name);
+/**
+ * @param: started pool, number of ranges deciding the redact chars, pattern
+ *         or dictionary, name of the list file
+ *
+ * @brief: redacts every file named in the list to the name with .redact
+ * appended, one after the other on the same pool
+ *
+ * @return: 0 if every file was redacted, -1 otherwise
+ * 
+*/
+#ifdef REDACT_MPI
+int redact_distributed(work_pool* pool, int num_threads, pattern_set* patterns,
+                       const char* input_name, const char* output_name);
+/**
+ * @param: started pool, number of threads of every processor, pattern or
+ *         dictionary, input file name, output file name
+ *
+ * @brief: --mpi mode, reads the processor's range of the file with its
+ * overlap, checks and redacts it with the pool, paints the occurences other
+ * processors found reaching into the range and writes the range of the
+ * output file collectively
+ *
+ * @return: 0 on success, -1 if the file could not be read or written
+ * 
+*/
+int transfer_all(MPI_File file, MPI_Offset offset, char* buffer, intmax_t length,
+                 int write);
+/**
+ * @param: opened file, where in the file, buffer, number of bytes, 1 to
+ *         write the buffer and 0 to read into it
+ *
+ * @brief: collective read or write in whole MAX_MESSAGE pieces and then the
+ * rest, since MPI counts are int
+ *
+ * @return: number of bytes read or written, -1 if MPI-IO failed
+ * 
+*/
+#endif
+void split_blocks(file_job* job, intmax_t first_range, int num_ranges,
+                  intmax_t total_ranges, intmax_t file_size, intmax_t offset,
+                  pattern_set* patterns, char* text, intmax_t text_length,
+                  int out_fd);
+/**
+ * @param: job to fill in, first range and number of ranges to split, number
+ *         of ranges the file is split into, size of the file, index in the
+ *         file of text[0], pattern or dictionary, text, bytes in the text,
+ *         output file descriptor (-1 to write the text)
+ *
+ * @brief: cuts every range into blocks of at most FILE_BLOCK bytes, a block
+ * keeps the redact char of its range and its indexes are in the text
+ * 
+*/
+void check_pattern(intmax_t block, int thread, void* arg);
+/**
+ * @param: index of the block, id of the pool thread, void pointer of the
+ *         file_job
+ *
+ * @brief: pool task checking one block of the file for the pattern and
+ * recording where its occurences start
+ * 
+*/
+void find_matches(task_data* t_data, const char* text, intmax_t length,
+                  intmax_t starts);
+/**
+ * @param: block's data, text starting at t_data->first, its length, number
+ *         of starting positions owned
+ *
+ * @brief: scans the text with the matcher or the automaton and leaves the
+ * occurences starting before starts in the block's match list, ordered by
+ * start
+ * 
+*/
+void add_match(size_t position, void* arg);
+/**
+ * @param: position of an occurence from the start of the block, block's data
+ *
+ * @brief: report callback of matcher_scan, appends the occurence to the
+ * block's own match list, doubling the list when it is full. Only the
+ * thread checking the block touches the list
+ * 
+*/
+void add_dict_match(int32_t pattern_id, size_t position, void* arg);
+/**
+ * @param: id of the dictionary pattern, position of the occurence from the
+ *         start of the block, block's data
+ *
+ * @brief: report callback of ac_scan, appends the occurence like add_match
+ * 
+*/
+void append_match(task_data* t_data, intmax_t start, intmax_t end);
+/**
+ * @param: block's data, first and last (excluded) index of an occurence
+ *
+ * @brief: appends the occurence to the block's match list, doubling the
+ * list when it is full
+ * 
+*/
+int compare_matches(const void* a, const void* b);
+/**
+ * @param: two match_span pointers
+ *
+ * @brief: qsort comparison by start, then by end
+ *
+ * @return: negative, 0 or positive like strcmp
+ * 
+*/
+int read_patterns(char* file_name, char*** patterns, size_t** lengths);
+/**
+ * @param: string name of the dictionary file, where to store the patterns
+ *         and their lengths
+ *
+ * @brief: reads one pattern per line, keeping only printable ascii
+ * characters and skipping lines left empty
+ *
+ * @return: int number of patterns read
+ * 
+*/
+int copy_file(int in_fd, int out_fd, intmax_t size);
+/**
+ * @param: input file descriptor, output file descriptor, bytes to copy
+ *
+ * @brief: copies the input to the output without moving the bytes through
+ * user space, with copy_file_range or with sendfile when the file systems
+ * do not support it
+ *
+ * @return: 0 on success, -1 if copying failed
+ * 
+*/
+void redact_range(task_data* t_data, intmax_t start, intmax_t end);
+/**
+ * @param: thread's data, first and last (excluded) index to redact
+ *
+ * @brief: fills the range with the thread's redact char, in the text when it
+ * is writable, otherwise with pwrites to the output file
+ * 
+*/
+void redact_stream(int num_threads, pattern_set* patterns);
+/**
+ * @param: number of threads redacting blocks, pattern or dictionary
+ *
+ * @brief: --stream mode, sets up the ring, runs the reader, the threads and
+ * the writer until the input ends and every block is written
+ * 
+*/
+void * read_blocks(void * arg);
+/**
+ * @param: unused
+ *
+ * @brief: reader thread, reads stdin into free blocks of the ring. What a
+ * read returns is handed out right away but for the last pattern length - 1
+ * bytes, which stay as lookahead and start the next block
+ * 
+*/
+void * redact_blocks(void * thread_data);
+/**
+ * @param: void pointer of the thread's task_data
+ *
+ * @brief: takes blocks in order of the stream and redacts them until the
+ * reader is done and no block is left
+ * 
+*/
+void redact_block(task_data* t_data, stream_block* block);
+/**
+ * @param: thread's data, block to redact
+ *
+ * @brief: finds the occurences in the block with its carried bytes and
+ * lookahead and redacts the part of them inside the block
+ * 
+*/
+void * write_blocks(void * arg);
+/**
+ * @param: unused
+ *
+ * @brief: writer thread, writes redacted blocks to stdout in the order they
+ * were read and frees them for the reader
+ * 
+*/
+void redact_matches(intmax_t block, int thread, void* arg);
+/**
+ * @param: index of the block, id of the pool thread, void pointer of the
+ *         file_job
+ *
+ * @brief: pool task redacting the block's occurences once every block found
+ * its own. Bytes before the end of the block can only be covered by the
+ * block's own occurences, bytes past it are left to a later block whose
+ * occurences cover them, so the ranges written by different blocks never
+ * overlap and the later (higher thread id) occurence wins
+ * 
+*/
+double stats_clock(void);
+/**
+ * @brief: reads the monotonic clock for the timers of --stats
+ *
+ * @return: double seconds, always 0 unless built with -DREDACT_TIMERS
+ * 
+*/
+void add_count(intmax_t* counter, intmax_t amount);
 /**
- * @param: void pointer of an array of task_data
+ * @param: counter of the calling thread, amount to add
  *
- * @brief: check_pattern is the multi threading process where each
- * thread will check its own specified chunk of the file if the
- * pattern occurs. If it does, the thread will replace the pattern
- * with its corresponding redact character
- * if overlap higher thread id will over right the lower thread id
+ * @brief: adds to a counter only its thread writes, with a relaxed atomic
+ * store so the --progress reporter reads whole values
+ * 
+*/
+void count_steals(work_pool* pool);
+/**
+ * @param: pool that just finished a check job
+ *
+ * @brief: adds the blocks every thread stole in the job to its counters,
+ * the pool counts the steals of the last job only
+ * 
+*/
+void * report_progress(void * arg);
+/**
+ * @param: unused
+ *
+ * @brief: progress thread, every interval prints on stderr the bytes
+ * checked so far, the occurences found and the rate, until stopped
+ * 
+*/
+void print_stats(int mode, int rank, work_pool* pool, double seconds);
+/**
+ * @param: mode the program ran in, rank of the processor (-1 without
+ *         --mpi), pool of the threads (NULL in --stream), wall time
+ *
+ * @brief: prints the counters and times of every thread and their totals
+ * as one JSON object on stderr
  * 
 */
 
@@ -72,184 +494,1151 @@ int main(int argc, char *argv[]){
 
     int num_threads;
     char* pattern;
-    FILE* file; //file pointer to input file
-    char* output_name; //output file name
-    task_data *thread_data; //data of corresponding thread
-    pthread_attr_t attr; 
+    pattern_set patterns = {0}; //prepared once, used by every thread
+    bool dict = false; //pattern argument is a dictionary file
+    work_pool pool; //threads checking and redacting blocks of the files
 
-    int in_fd; //placeholder to get the size of the file
-    intmax_t file_size; //hold size of file
-    
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+    int mode = REDACT_MEMORY; //how the file is read and written
+    int arg = 1; //first positional arg
+    int status = 0; //exit status
+    bool show_stats = false; //print the counters as JSON at the end
+    int rank = -1; //rank of the processor in --mpi
 
-    if (argc != 5){ 
-        //if it doesnt have 5 number of command line args
-        fprintf(stderr, "Usage: redact <number of threads> <pattern> <input file> <output file>\n");
+    //options of the reports come before the mode
+    for(;;){
+        if(argc > arg && strcmp(argv[arg], "--stats") == 0){
+            show_stats = true;
+            arg++;
+        }else if(argc > arg + 1 && strcmp(argv[arg], "--progress") == 0){
+            progress.interval = atof(argv[arg + 1]);
+            if(progress.interval <= 0){
+                fprintf(stderr, "Provide a valid progress interval!\n");
+                exit(1);
+            }
+            arg += 2;
+        }else{
+            break;
+        }
+    }
+    if(argc > arg && strcmp(argv[arg], "--mmap") == 0){
+        mode = REDACT_MMAP;
+        arg++;
+    }else if(argc > arg && strcmp(argv[arg], "--in-place") == 0){
+        mode = REDACT_IN_PLACE;
+        arg++;
+    }else if(argc > arg && strcmp(argv[arg], "--stream") == 0){
+        mode = REDACT_STREAM;
+        arg++;
+    }else if(argc > arg && strcmp(argv[arg], "--batch") == 0){
+        mode = REDACT_BATCH;
+        arg++;
+#ifdef REDACT_MPI
+    }else if(argc > arg && strcmp(argv[arg], "--mpi") == 0){
+        mode = REDACT_DISTRIBUTED;
+        arg++;
+#endif
+    }
+    if(argc > arg && strcmp(argv[arg], "--dict") == 0){
+        dict = true;
+        arg++;
+    }
+    if (argc != arg + (mode == REDACT_STREAM ? 2 : (mode == REDACT_IN_PLACE || mode == REDACT_BATCH) ? 3 : 4)){ 
+        //if it doesnt have the right number of command line args
+        fprintf(stderr, "Usage: redact [--mmap] [--dict] <number of threads> <pattern> <input file> <output file>\n"
+                        "       redact --in-place [--dict] <number of threads> <pattern> <file>\n"
+                        "       redact --stream [--dict] <number of threads> <pattern>\n"
+                        "       redact --batch [--dict] <number of threads> <pattern> <list file>\n"
+                        MPI_USAGE
+                        OPTIONS_USAGE);
         exit(1);
     }
     
     //check number of thread arg
-    for(int i = 0; i < strlen(argv[1]);i ++){
-        if(!isdigit(argv[1][i])){
+    for(int i = 0; i < strlen(argv[arg]);i ++){
+        if(!isdigit(argv[arg][i])){
             fprintf(stderr, "Provide a valid number of threads!\n");
             exit(1);
         }
     }
-    num_threads = atoi(argv[1]);
+    num_threads = atoi(argv[arg]);
+    if(num_threads < 1){
+        fprintf(stderr, "Provide a valid number of threads!\n");
+        exit(1);
+    }
 
     //handle pattern arg
-    pattern = strdup(argv[2]);  // Use strdup to copy string
+    pattern = strdup(argv[arg + 1]);  // Use strdup to copy string
+    if(dict){
+        char** words = NULL; //patterns of the dictionary
+        size_t* lengths = NULL; //their lengths
+        int count = read_patterns(pattern, &words, &lengths);
+        if(count == 0){
+            fprintf(stderr, "Dictionary file has no valid patterns!\n");
+            exit(1);
+        }
+        if(ac_build(&patterns.automaton, words, lengths, count) != 0){
+            fprintf(stderr, "Failed to build the dictionary automaton!\n");
+            exit(1);
+        }
+        for(int i = 0; i < count; i++){
+            free(words[i]);
+        }
+        free(words);
+        free(lengths);
+        patterns.dict = true;
+        patterns.max_length = patterns.automaton.max_length;
+    }else{
+        if(matcher_init(&patterns.single, pattern, strlen(pattern)) != 0){
+            fprintf(stderr, "Provide a non empty pattern!\n");
+            exit(1);
+        }
+        patterns.max_length = patterns.single.length;
+    }
+#ifdef REDACT_MPI
+    if(mode == REDACT_DISTRIBUTED){
+        //MPI starts before any thread does, only the main thread calls it
+        int provided;
+        MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+        if(provided < MPI_THREAD_FUNNELED){
+            fprintf(stderr, "MPI does not support calls from the main thread of a threaded program!\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    }
+#endif
+
+    //two cache lines of counters per thread, no two threads share one
+    num_stats = num_threads;
+    stats = (thread_stats *)aligned_alloc(CACHE_LINE, num_threads * sizeof(thread_stats));
+    if(stats == NULL){
+        fprintf(stderr, "Failed to allocate memory for stats!\n");
+        exit(1);
+    }
+    memset(stats, 0, num_threads * sizeof(thread_stats));
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    if(progress.interval > 0){
+        pthread_condattr_t attr; //the reporter waits on the monotonic clock
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_mutex_init(&progress.lock, NULL);
+        pthread_cond_init(&progress.stopped, &attr);
+        pthread_condattr_destroy(&attr);
+        if(pthread_create(&progress.thread_id, NULL, report_progress, NULL)){
+            fprintf(stderr, "error creating pthread");
+            exit(-1);
+        }
+    }
+
+    if(mode == REDACT_STREAM){
+        redact_stream(num_threads, &patterns);
+    }else{
 
-    //handles output file arg
-    output_name = strdup(argv[4]);  // Use strdup to copy string
+        //the threads are created once, whatever the number of files
+        if(pool_init(&pool, num_threads) != 0){
+            fprintf(stderr, "error creating pthread");
+            exit(-1);
+        }
+        if(mode == REDACT_BATCH){
+            status = redact_batch(&pool, num_threads, &patterns, argv[arg + 2]);
+#ifdef REDACT_MPI
+        }else if(mode == REDACT_DISTRIBUTED){
+            //only the main thread calls MPI, the pool threads never do
+            status = redact_distributed(&pool, num_threads, &patterns,
+                                        argv[arg + 2], argv[arg + 3]);
+#endif
+        }else{
+            //handles file args
+            char* output_name = (mode == REDACT_IN_PLACE) ? NULL : argv[arg + 3];
+            status = redact_file(&pool, mode, num_threads, &patterns,
+                                 argv[arg + 2], output_name);
+        }
+    }
+
+    if(progress.interval > 0){
+        pthread_mutex_lock(&progress.lock);
+        progress.stop = true;
+        pthread_cond_signal(&progress.stopped);
+        pthread_mutex_unlock(&progress.lock);
+        pthread_join(progress.thread_id, NULL);
+        pthread_mutex_destroy(&progress.lock);
+        pthread_cond_destroy(&progress.stopped);
+    }
+    if(show_stats){
+        struct timespec finished;
+        clock_gettime(CLOCK_MONOTONIC, &finished);
+        print_stats(mode, rank, mode == REDACT_STREAM ? NULL : &pool,
+                    (finished.tv_sec - started.tv_sec)
+                    + (finished.tv_nsec - started.tv_nsec) / 1e9);
+    }
+    if(mode != REDACT_STREAM){
+        pool_free(&pool);
+    }
+    free(stats);
+#ifdef REDACT_MPI
+    if(mode == REDACT_DISTRIBUTED){
+        //every thread is joined by now
+        MPI_Finalize();
+    }
+#endif
+
+    //free memory used
+    if(patterns.dict){
+        ac_free(&patterns.automaton);
+    }else{
+        matcher_free(&patterns.single);
+    }
+    free(pattern);
+    return (status == 0) ? 0 : 1;
+}
+
+
+int redact_file(work_pool* pool, int mode, int num_ranges, pattern_set* patterns,
+                const char* input_name, const char* output_name){
+    int in_fd; //input file descriptor
+    int out_fd = -1; //output file descriptor of --mmap
+    intmax_t file_size; //hold size of file
+    char* text = NULL; //the file in memory or mapped
+    file_job job; //blocks of the file
 
     //handle input file
     //get file size
-    if ( ( in_fd = open ( argv [3] , O_RDONLY ) ) == -1 ) {
-        fprintf(stderr, "Couldn't read the file!\n");
-        exit(1);
+    if ( ( in_fd = open ( input_name , mode == REDACT_IN_PLACE ? O_RDWR : O_RDONLY ) ) == -1 ) {
+        fprintf(stderr, "Couldn't read the file %s!\n", input_name);
+        return -1;
     }
     file_size = lseek ( in_fd , 0 , SEEK_END ) ;
-    close ( in_fd );
 
-    file = fopen(argv[3],"r");
-    input_text = (char *)malloc((file_size + 1) * sizeof(char));
-    if(input_text == NULL){
-        fprintf(stderr, "Failed to allocate memory for text!\n");
+    if(mode == REDACT_MEMORY){
+        text = (char *)malloc((file_size + 1) * sizeof(char));
+        if(text == NULL){
+            fprintf(stderr, "Failed to allocate memory for text!\n");
+            exit(1);
+        }
+        if(pread(in_fd, text, file_size, 0) != file_size){
+            fprintf(stderr, "Couldn't read the file %s!\n", input_name);
+            free(text);
+            close(in_fd);
+            return -1;
+        }
+        text[file_size] = '\0';
+    }else if(file_size > 0){
+        //an empty file can not be mapped and has nothing to redact
+        text = (char *)mmap(NULL, file_size,
+                            mode == REDACT_IN_PLACE ? PROT_READ | PROT_WRITE : PROT_READ,
+                            mode == REDACT_IN_PLACE ? MAP_SHARED : MAP_PRIVATE, in_fd, 0);
+        if(text == MAP_FAILED){
+            fprintf(stderr, "Couldn't map the file %s!\n", input_name);
+            close(in_fd);
+            return -1;
+        }
+        madvise(text, file_size, MADV_SEQUENTIAL);
+    }
+
+    if(mode == REDACT_MMAP){
+        //the copy is in place before any thread writes its ranges over it
+        out_fd = open(output_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(out_fd == -1 || copy_file(in_fd, out_fd, file_size) != 0){
+            fprintf(stderr, "Failed to copy the file to the output file %s!\n", output_name);
+            if(out_fd != -1){
+                close(out_fd);
+            }
+            if(file_size > 0){
+                munmap(text, file_size);
+            }
+            close(in_fd);
+            return -1;
+        }
+    }
+
+    //every range of the old one thread per range split is cut into blocks,
+    //a block keeps the redact char of its range
+    split_blocks(&job, 0, num_ranges, num_ranges, file_size, 0, patterns, text,
+                 file_size, out_fd);
+    add_count(&progress.total, file_size);
+
+    //every block is checked before any is redacted, the text is not touched
+    //while another thread may still read it
+    double began = stats_clock();
+    if(pool_run(pool, job.num_blocks, check_pattern, &job) != 0){
+        fprintf(stderr, "Failed to allocate memory for blocks!\n");
+        exit(1);
+    }
+    count_steals(pool);
+    if(pool_run(pool, job.num_blocks, redact_matches, &job) != 0){
+        fprintf(stderr, "Failed to allocate memory for blocks!\n");
         exit(1);
     }
-    fread(input_text, 1, file_size, file);
-    input_text[file_size] = '\0';
+    pool_time += stats_clock() - began;
+    
+    int status = 0;
+    if(mode == REDACT_MEMORY){
+        //write to output file
+        FILE *output;
+        output = fopen(output_name, "w");
+        //write to the output file, all of it even past a NUL byte
+        if(output == NULL || fwrite(text, 1, file_size, output) != file_size){
+            fprintf(stderr, "Failed to write the output file %s!\n", output_name);
+            status = -1;
+        }
+        if(output != NULL){
+            fclose(output);
+        }
+        free(text);
+    }else if(file_size > 0){
+        if(mode == REDACT_IN_PLACE){
+            msync(text, file_size, MS_SYNC);
+        }
+        munmap(text, file_size);
+    }
+
+    //close and free memory used
+    if(out_fd != -1){
+        close(out_fd);
+    }
+    close(in_fd);
+    for(intmax_t k = 0; k < job.num_blocks; k++){
+        free(job.blocks[k].matches);
+    }
+    free(job.blocks);
+    return status;
+}
+
+int redact_batch(work_pool* pool, int num_ranges, pattern_set* patterns,
+                 const char* list_name){
+    FILE* list = fopen(list_name, "r");
+    if(list == NULL){
+        fprintf(stderr, "Couldn't read the file %s!\n", list_name);
+        return -1;
+    }
+    int status = 0;
+    char* line = NULL; //current line of the list
+    size_t line_capacity = 0;
+    ssize_t line_length;
+    char* output_name = NULL; //input file name with .redact appended
+    size_t output_capacity = 0;
+    while((line_length = getline(&line, &line_capacity, list)) != -1){
+        if(line_length > 0 && line[line_length - 1] == '\n'){
+            line[--line_length] = '\0';
+        }
+        if(line_length == 0){
+            continue;
+        }
+        if(output_capacity < line_length + sizeof(".redact")){
+            output_capacity = line_length + sizeof(".redact");
+            output_name = (char *)realloc(output_name, output_capacity);
+            if(output_name == NULL){
+                fprintf(stderr, "Failed to allocate memory for file names!\n");
+                exit(1);
+            }
+        }
+        snprintf(output_name, output_capacity, "%s.redact", line);
+        //a file that fails is reported and the batch goes on
+        if(redact_file(pool, REDACT_MMAP, num_ranges, patterns, line, output_name) != 0){
+            status = -1;
+        }
+    }
+    free(line);
+    free(output_name);
+    fclose(list);
+    return status;
+}
+
+#ifdef REDACT_MPI
+int redact_distributed(work_pool* pool, int num_threads, pattern_set* patterns,
+                       const char* input_name, const char* output_name){
+    int id, p; //rank of this processor and number of processors
+    MPI_File in_file, out_file;
+    MPI_Offset file_size;
+    file_job job; //blocks of the processor's range
+    MPI_Comm_rank(MPI_COMM_WORLD, &id);
+    MPI_Comm_size(MPI_COMM_WORLD, &p);
+
+    if(MPI_File_open(MPI_COMM_WORLD, input_name, MPI_MODE_RDONLY, MPI_INFO_NULL,
+                     &in_file) != MPI_SUCCESS){
+        if(id == 0){
+            fprintf(stderr, "Couldn't read the file %s!\n", input_name);
+        }
+        return -1;
+    }
+    MPI_File_get_size(in_file, &file_size);
+
+    //the processor's ranges are ranges id * threads on of a run with
+    //p * threads threads, the first of them starts the processor's bytes
+    intmax_t total_ranges = (intmax_t)p * num_threads;
+    intmax_t start = (id * num_threads * (intmax_t)file_size) / total_ranges;
+    intmax_t end = ((id + 1) * num_threads * (intmax_t)file_size) / total_ranges;
+    intmax_t text_length = end + patterns->max_length - 1; //range and overlap
+    if(text_length > file_size){
+        text_length = file_size;
+    }
+    text_length -= start;
+    char* text = (char *)malloc(text_length + 1);
+    if(text == NULL){
+        fprintf(stderr, "Failed to allocate memory for text!\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if(transfer_all(in_file, start, text, text_length, 0) != text_length){
+        fprintf(stderr, "Couldn't read the file %s!\n", input_name);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_File_close(&in_file);
+
+    split_blocks(&job, id * num_threads, num_threads, total_ranges, file_size,
+                 start, patterns, text, text_length, -1);
+    add_count(&progress.total, end - start);
+    double began = stats_clock();
+    if(pool_run(pool, job.num_blocks, check_pattern, &job) != 0){
+        fprintf(stderr, "Failed to allocate memory for blocks!\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    count_steals(pool);
+    pool_time += stats_clock() - began;
+
+    //occurences running past the end of the range, in order of start
+    int num_spans = 0;
+    int spans_capacity = 0;
+    boundary_span* spans = NULL;
+    for(intmax_t b = 0; b < job.num_blocks; b++){
+        for(intmax_t j = 0; j < job.blocks[b].num_matches; j++){
+            if(start + job.blocks[b].matches[j].end <= end){
+                continue;
+            }
+            if(num_spans == spans_capacity){
+                spans_capacity = spans_capacity ? 2 * spans_capacity : 64;
+                spans = (boundary_span *)realloc(spans, spans_capacity * sizeof(boundary_span));
+                if(spans == NULL){
+                    fprintf(stderr, "error allocating memory of matches");
+                    MPI_Abort(MPI_COMM_WORLD, 1);
+                }
+            }
+            spans[num_spans].start = start + job.blocks[b].matches[j].start;
+            spans[num_spans].end = start + job.blocks[b].matches[j].end;
+            spans[num_spans].redact_char = job.blocks[b].redact_char;
+            num_spans++;
+        }
+    }
+
+    //every processor gets every span, they are few: at most pattern length - 1
+    //per processor for one pattern
+    int* counts = (int *)malloc(p * sizeof(int));
+    int* displacements = (int *)malloc(p * sizeof(int));
+    if(counts == NULL || displacements == NULL){
+        fprintf(stderr, "Failed to allocate memory for blocks!\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    int values = 3 * num_spans; //int64_t values of the processor's spans
+    MPI_Allgather(&values, 1, MPI_INT, counts, 1, MPI_INT, MPI_COMM_WORLD);
+    int total_values = 0;
+    for(int q = 0; q < p; q++){
+        displacements[q] = total_values;
+        total_values += counts[q];
+    }
+    boundary_span* all_spans = (boundary_span *)malloc(total_values * sizeof(int64_t) + 1);
+    if(all_spans == NULL){
+        fprintf(stderr, "Failed to allocate memory for blocks!\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Allgatherv(spans, values, MPI_INT64_T, all_spans, counts, displacements,
+                   MPI_INT64_T, MPI_COMM_WORLD);
+
+    //spans of the processors before come in order of start, paint the ones
+    //reaching into the range, later ones and then our own occurences win
+    for(int k = 0; k < displacements[id] / 3; k++){
+        intmax_t from = (all_spans[k].start > start) ? all_spans[k].start : start;
+        intmax_t to = (all_spans[k].end < end) ? all_spans[k].end : end;
+        if(from < to){
+            memset(text + from - start, (char)all_spans[k].redact_char, to - from);
+        }
+    }
+    free(spans);
+    free(all_spans);
+    free(counts);
+    free(displacements);
+
+    began = stats_clock();
+    if(pool_run(pool, job.num_blocks, redact_matches, &job) != 0){
+        fprintf(stderr, "Failed to allocate memory for blocks!\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    pool_time += stats_clock() - began;
+
+    //every processor writes its own range, the overlap belongs to the next one
+    int status = 0;
+    if(MPI_File_open(MPI_COMM_WORLD, output_name, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                     MPI_INFO_NULL, &out_file) != MPI_SUCCESS){
+        status = -1;
+    }else{
+        MPI_File_set_size(out_file, file_size); //drop what an older file had past it
+        if(transfer_all(out_file, start, text, end - start, 1) != end - start){
+            status = -1;
+        }
+        MPI_File_close(&out_file);
+    }
+    int failed = (status != 0); //whether any processor failed to write
+    MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if(failed){
+        if(id == 0){
+            fprintf(stderr, "Failed to write the output file %s!\n", output_name);
+        }
+        status = -1;
+    }
+
+    for(intmax_t k = 0; k < job.num_blocks; k++){
+        free(job.blocks[k].matches);
+    }
+    free(job.blocks);
+    free(text);
+    return status;
+}
+
+int transfer_all(MPI_File file, MPI_Offset offset, char* buffer, intmax_t length,
+                 int write){
+    MPI_Datatype piece; //MAX_MESSAGE bytes
+    MPI_Type_contiguous(MAX_MESSAGE, MPI_CHAR, &piece);
+    MPI_Type_commit(&piece);
+    intmax_t pieces = length / MAX_MESSAGE;
+    intmax_t rest = length % MAX_MESSAGE;
+    MPI_Status status;
+    MPI_Count moved; //bytes read or written by a call
+    intmax_t total = 0;
+    int result;
+    //every processor makes both calls, they are collective
+    if(write){
+        result = MPI_File_write_at_all(file, offset, buffer, pieces, piece, &status);
+    }else{
+        result = MPI_File_read_at_all(file, offset, buffer, pieces, piece, &status);
+    }
+    MPI_Get_elements_x(&status, MPI_CHAR, &moved);
+    total += moved;
+    if(write){
+        result |= MPI_File_write_at_all(file, offset + pieces * MAX_MESSAGE,
+                                        buffer + pieces * MAX_MESSAGE, rest, MPI_CHAR, &status);
+    }else{
+        result |= MPI_File_read_at_all(file, offset + pieces * MAX_MESSAGE,
+                                       buffer + pieces * MAX_MESSAGE, rest, MPI_CHAR, &status);
+    }
+    MPI_Get_elements_x(&status, MPI_CHAR, &moved);
+    total += moved;
+    MPI_Type_free(&piece);
+    return (result == MPI_SUCCESS) ? total : -1;
+}
+#endif
 
-    //handles flag
-    flag = (int * )malloc(file_size * sizeof(int));
-    if(flag == NULL){
-        fprintf(stderr, "Failed to allocate memory!\n");
+void split_blocks(file_job* job, intmax_t first_range, int num_ranges,
+                  intmax_t total_ranges, intmax_t file_size, intmax_t offset,
+                  pattern_set* patterns, char* text, intmax_t text_length,
+                  int out_fd){
+    job->num_blocks = 0;
+    for(intmax_t i = first_range; i < first_range + num_ranges; i++){
+        intmax_t length = ((i + 1) * file_size) / total_ranges - (i * file_size) / total_ranges;
+        job->num_blocks += (length + FILE_BLOCK - 1) / FILE_BLOCK;
+    }
+    job->blocks = calloc(job->num_blocks + 1, sizeof(task_data));
+    if(job->blocks == NULL){
+        fprintf(stderr, "error calloc block data");
         exit(1);
     }
-    //initialize every cell of flag to -1
-    for(int i = 0; i < file_size; i++){
-        flag[i] = -1;
+    intmax_t b = 0;
+    for(intmax_t i = first_range; i < first_range + num_ranges; i++){
+        intmax_t first = (i * file_size) / total_ranges - offset;
+        intmax_t length = ((i + 1) * file_size) / total_ranges - (i * file_size) / total_ranges;
+        intmax_t pieces = (length + FILE_BLOCK - 1) / FILE_BLOCK;
+        for(intmax_t k = 0; k < pieces; k++, b++){
+            job->blocks[b].first = first + (k * length) / pieces;
+            job->blocks[b].last = first + ((k + 1) * length) / pieces;
+            job->blocks[b].patterns = patterns;
+            job->blocks[b].file_size = text_length;
+            job->blocks[b].text = text;
+            job->blocks[b].out_fd = out_fd;
+            job->blocks[b].redact_char = redact_string[i % 64];
+            job->blocks[b].id = b;
+        }
+    }
+}
+
+void check_pattern(intmax_t block, int thread, void* arg){
+    task_data* t_data = &((file_job*) arg)->blocks[block];
+    thread_stats* counters = &stats[thread]; //only this thread writes them
+    double began = stats_clock();
+
+    //check the positions of this block on the shared text, the text after
+    //the block is still there for occurences crossing its end
+    t_data->num_matches = 0;
+    if(t_data->last > t_data->first){
+        find_matches(t_data, t_data->text + t_data->first, t_data->file_size - t_data->first,
+                     t_data->last - t_data->first);
+    }
+    counters->check_time += stats_clock() - began;
+    add_count(&counters->blocks, 1);
+    add_count(&counters->bytes, t_data->last - t_data->first);
+    add_count(&counters->matches, t_data->num_matches);
+}
+
+void find_matches(task_data* t_data, const char* text, intmax_t length,
+                  intmax_t starts){
+    if(!t_data->patterns->dict){
+        matcher_scan(&t_data->patterns->single, text, length, starts, add_match, t_data);
+        return;
     }
+    ac_scan(&t_data->patterns->automaton, text, length, starts, add_dict_match, t_data);
+    //the automaton reports by where occurences end
+    qsort(t_data->matches, t_data->num_matches, sizeof(match_span), compare_matches);
+}
 
-    thread_data = calloc(num_threads, sizeof(task_data));
-    if(thread_data == NULL){
-        fprintf(stderr, "error calloc thread data");
+void add_match(size_t position, void* arg){
+    task_data* t_data = (task_data*) arg;
+    intmax_t start = t_data->first + position;
+    append_match(t_data, start, start + t_data->patterns->single.length);
+}
+
+void add_dict_match(int32_t pattern_id, size_t position, void* arg){
+    task_data* t_data = (task_data*) arg;
+    intmax_t start = t_data->first + position;
+    append_match(t_data, start, start + t_data->patterns->automaton.lengths[pattern_id]);
+}
+
+void append_match(task_data* t_data, intmax_t start, intmax_t end){
+    if(t_data->num_matches == t_data->capacity){
+        t_data->capacity = t_data->capacity ? 2 * t_data->capacity : MATCH_CAPACITY;
+        t_data->matches = (match_span *)realloc(t_data->matches,
+                                                t_data->capacity * sizeof(match_span));
+        if(t_data->matches == NULL){
+            fprintf(stderr, "error allocating memory of matches");
+            exit(-1);
+        }
+    }
+    t_data->matches[t_data->num_matches].start = start;
+    t_data->matches[t_data->num_matches].end = end;
+    t_data->num_matches++;
+}
+
+int compare_matches(const void* a, const void* b){
+    const match_span* x = (const match_span*) a;
+    const match_span* y = (const match_span*) b;
+    if(x->start != y->start){
+        return (x->start < y->start) ? -1 : 1;
+    }
+    return (x->end < y->end) ? -1 : (x->end > y->end);
+}
+
+int read_patterns(char* file_name, char*** patterns, size_t** lengths){
+    FILE* file = fopen(file_name, "r");
+    if(file == NULL){
+        fprintf(stderr, "Couldn't read the dictionary file!\n");
         exit(1);
     }
-    //intialize barrier
-    pthread_barrier_init(&barrier,NULL,num_threads);
-    pthread_mutex_init(&update_mutex , NULL ) ;
+    int count = 0; //number of patterns kept
+    int capacity = 0; //number of patterns the arrays can hold
+    char* line = NULL; //current line, grown by getline
+    size_t line_capacity = 0;
+    ssize_t line_length;
+    *patterns = NULL;
+    *lengths = NULL;
+    while((line_length = getline(&line, &line_capacity, file)) != -1){
+        int c = 0;
+        for(ssize_t i = 0; i < line_length; i++){
+            if(line[i] >= 32 && line[i] <= 126){
+                //make sure only valid ascii characters
+                line[c] = line[i];
+                c++;
+            }
+        }
+        if(c == 0){
+            continue;
+        }
+        if(count == capacity){
+            capacity = capacity ? 2 * capacity : 64;
+            *patterns = (char **)realloc(*patterns, capacity * sizeof(char*));
+            *lengths = (size_t *)realloc(*lengths, capacity * sizeof(size_t));
+            if(*patterns == NULL || *lengths == NULL){
+                fprintf(stderr, "Pattern memory allocation failed!\n");
+                exit(1);
+            }
+        }
+        (*patterns)[count] = strndup(line, c);
+        if((*patterns)[count] == NULL){
+            fprintf(stderr, "Pattern memory allocation failed!\n");
+            exit(1);
+        }
+        (*lengths)[count] = c;
+        count++;
+    }
+    free(line);
+    fclose(file);
+    return count;
+}
 
-    //redact string of thread where its corresponding char will be id % 64
-    char* redact_string = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_ ";
-    int retval;
+void redact_matches(intmax_t block, int thread, void* arg){
+    file_job* job = (file_job*) arg;
+    task_data* t_data = &job->blocks[block];
+    if(t_data->num_matches == 0){
+        return;
+    }
+    thread_stats* counters = &stats[thread]; //only this thread writes them
+    double began = stats_clock();
+    intmax_t overlaps = 0; //occurences starting inside an earlier one
+    intmax_t redacted = 0; //bytes filled
+    intmax_t reach = t_data->first; //where the earlier occurences end
+    //overlapping occurences of the block make one range, written at once,
+    //only up to the end of the block where no later block can start
+    intmax_t run_start = 0, run_end = 0;
+    intmax_t tail_end = t_data->last; //where the block's last occurence ends
+    for(intmax_t j = 0; j < t_data->num_matches; j++){
+        intmax_t start = t_data->matches[j].start;
+        intmax_t end = t_data->matches[j].end;
+        overlaps += (start < reach);
+        reach = (end > reach) ? end : reach;
+        tail_end = (end > tail_end) ? end : tail_end;
+        end = (end > t_data->last) ? t_data->last : end;
+        if(start > run_end){
+            redact_range(t_data, run_start, run_end);
+            redacted += run_end - run_start;
+            run_start = start;
+        }
+        run_end = (end > run_end) ? end : run_end;
+    }
+    redact_range(t_data, run_start, run_end);
+    redacted += run_end - run_start;
+    if(tail_end == t_data->last){
+        counters->redact_time += stats_clock() - began;
+        add_count(&counters->overlaps, overlaps);
+        add_count(&counters->redacted, redacted);
+        return;
+    }
 
-    for(int i = 0; i < num_threads; i++){
+    //past the end of the block the bytes covered by later blocks' occurences
+    //are theirs, only blocks starting before tail_end can hold such ones
+    intmax_t tail_length = tail_end - t_data->last;
+    char* own = (char *)calloc(tail_length, sizeof(char)); //1 for bytes kept
+    if(own == NULL){
+        fprintf(stderr, "error allocating memory of matches");
+        exit(-1);
+    }
+    for(intmax_t j = 0; j < t_data->num_matches; j++){
+        for(intmax_t k = t_data->last; k < t_data->matches[j].end; k++){
+            own[k - t_data->last] = 1;
+        }
+    }
+    for(intmax_t b = block + 1; b < job->num_blocks && job->blocks[b].first < tail_end; b++){
+        task_data* later = &job->blocks[b];
+        for(intmax_t j = 0; j < later->num_matches && later->matches[j].start < tail_end; j++){
+            //a later block's occurence takes bytes this block's reached
+            overlaps++;
+            intmax_t end = (later->matches[j].end < tail_end) ? later->matches[j].end : tail_end;
+            for(intmax_t k = later->matches[j].start; k < end; k++){
+                own[k - t_data->last] = 0;
+            }
+        }
+    }
+    for(intmax_t k = 0; k < tail_length; ){
+        if(!own[k]){
+            k++;
+            continue;
+        }
+        intmax_t start = k;
+        while(k < tail_length && own[k]){
+            k++;
+        }
+        redact_range(t_data, t_data->last + start, t_data->last + k);
+        redacted += k - start;
+    }
+    free(own);
+    counters->redact_time += stats_clock() - began;
+    add_count(&counters->overlaps, overlaps);
+    add_count(&counters->redacted, redacted);
+}
 
-        thread_data[i].first = (i * file_size) / num_threads;
-        thread_data[i].last = ((i + 1) * file_size) / num_threads;
-        thread_data[i].pattern = pattern;
-        thread_data[i].file_size = file_size;
-        thread_data[i].text = input_text;
-        thread_data[i].flag = flag;
-        thread_data[i].redact_char = redact_string[i % 64];
-        thread_data[i].id = i;
-        thread_data[i].text = input_text;
+int copy_file(int in_fd, int out_fd, intmax_t size){
+    loff_t in_offset = 0, out_offset = 0;
+    while(in_offset < size){
+        ssize_t copied = copy_file_range(in_fd, &in_offset, out_fd, &out_offset,
+                                         size - in_offset, 0);
+        if(copied > 0){
+            continue;
+        }
+        if(copied == 0 || (errno != EXDEV && errno != ENOSYS && errno != EINVAL &&
+                           errno != EOPNOTSUPP)){
+            return -1;
+        }
+        break;
+    }
+    //sendfile goes on from where copy_file_range stopped
+    off_t offset = in_offset;
+    if(lseek(out_fd, offset, SEEK_SET) == -1){
+        return -1;
+    }
+    while(offset < size){
+        if(sendfile(out_fd, in_fd, &offset, size - offset) <= 0){
+            return -1;
+        }
+    }
+    return 0;
+}
 
-        retval = pthread_create(&(thread_data[i].thread_id),&attr,
-                                check_pattern, (void *) &thread_data[i]);
-        if(retval){
-            fprintf(stderr, "error creating pthread");
+void redact_range(task_data* t_data, intmax_t start, intmax_t end){
+    if(t_data->out_fd == -1){
+        memset(t_data->text + start, t_data->redact_char, end - start);
+        return;
+    }
+    char fill[FILL_SIZE];
+    memset(fill, t_data->redact_char, FILL_SIZE);
+    while(start < end){
+        intmax_t length = (end - start < FILL_SIZE) ? end - start : FILL_SIZE;
+        ssize_t written = pwrite(t_data->out_fd, fill, length, start);
+        if(written <= 0){
+            fprintf(stderr, "Failed to write the output file!\n");
             exit(-1);
-        }   
-    }   
-    //join all threads
-    for( int t = 0 ; t < num_threads ; t++) {
-        pthread_join ( thread_data [ t ] . thread_id , ( void ** ) NULL ) ;
+        }
+        start += written;
     }
-    
-    //write to output file
-    FILE *output;
-    output = fopen(output_name, "w");
-    if(output == NULL){
-        fprintf(stderr, "Failed to open output file!\n");
+}
+
+void redact_stream(int num_threads, pattern_set* patterns){
+    intmax_t keep = patterns->max_length - 1; //bytes carried and held back
+    task_data* thread_data = calloc(num_threads, sizeof(task_data));
+    ring.num_blocks = 2 * num_threads + 2; //a block for each thread to read, redact and write
+    ring.blocks = calloc(ring.num_blocks, sizeof(stream_block));
+    if(thread_data == NULL || ring.blocks == NULL){
+        fprintf(stderr, "Failed to allocate memory for blocks!\n");
         exit(1);
     }
-    //write to the output file
-    fprintf(output,"%s",input_text);
+    for(int b = 0; b < ring.num_blocks; b++){
+        ring.blocks[b].data = (char *)malloc(STREAM_BLOCK + 2 * keep);
+        if(ring.blocks[b].data == NULL){
+            fprintf(stderr, "Failed to allocate memory for blocks!\n");
+            exit(1);
+        }
+        ring.blocks[b].state = BLOCK_FREE;
+    }
+    ring.patterns = patterns;
+    pthread_mutex_init(&ring.lock, NULL);
+    pthread_cond_init(&ring.changed, NULL);
 
-    //close and free memory used
-    fclose(output);
-    fclose(file);
-    free(input_text);
+    pthread_t reader, writer;
+    if(pthread_create(&reader, NULL, read_blocks, NULL) ||
+       pthread_create(&writer, NULL, write_blocks, NULL)){
+        fprintf(stderr, "error creating pthread");
+        exit(-1);
+    }
+    for(int i = 0; i < num_threads; i++){
+        thread_data[i].patterns = patterns;
+        thread_data[i].out_fd = -1;
+        thread_data[i].redact_char = redact_string[0];
+        thread_data[i].id = i;
+        if(pthread_create(&(thread_data[i].thread_id), NULL, redact_blocks,
+                          (void *) &thread_data[i])){
+            fprintf(stderr, "error creating pthread");
+            exit(-1);
+        }
+    }
+    pthread_join(reader, NULL);
+    for(int t = 0; t < num_threads; t++){
+        pthread_join(thread_data[t].thread_id, NULL);
+    }
+    pthread_join(writer, NULL);
+
+    for(int t = 0; t < num_threads; t++){
+        free(thread_data[t].matches);
+    }
     free(thread_data);
-    free(flag);
-    pthread_barrier_destroy(&barrier);
-    pthread_mutex_destroy(&update_mutex);
+    for(int b = 0; b < ring.num_blocks; b++){
+        free(ring.blocks[b].data);
+    }
+    free(ring.blocks);
+    pthread_mutex_destroy(&ring.lock);
+    pthread_cond_destroy(&ring.changed);
 }
 
+void * read_blocks(void * arg){
+    intmax_t keep = ring.patterns->max_length - 1;
+    //bytes read but not written yet, up to keep carried bytes and keep held back
+    char* tail = (char *)malloc(2 * keep + 1);
+    intmax_t tail_carry = 0, tail_length = 0;
+    if(tail == NULL){
+        fprintf(stderr, "Failed to allocate memory for blocks!\n");
+        exit(-1);
+    }
+    for(;;){
+        pthread_mutex_lock(&ring.lock);
+        stream_block* block = &ring.blocks[ring.num_read % ring.num_blocks];
+        while(block->state != BLOCK_FREE){
+            pthread_cond_wait(&ring.changed, &ring.lock);
+        }
+        pthread_mutex_unlock(&ring.lock);
 
-void * check_pattern(void * thread_data){
+        memcpy(block->data, tail, tail_length);
+        ssize_t got;
+        do{
+            got = read(STDIN_FILENO, block->data + tail_length, STREAM_BLOCK);
+        }while(got == -1 && errno == EINTR);
+        if(got == -1){
+            fprintf(stderr, "Couldn't read the input!\n");
+            exit(-1);
+        }
+        intmax_t total = tail_length + got;
+        //at the end of the input nothing more can complete an occurence
+        intmax_t held = (got == 0) ? 0 : keep;
+        if(total - held <= tail_carry){
+            //too little to hand out a block, keep it all for the next read
+            memcpy(tail, block->data, total);
+            tail_length = total;
+            if(got != 0){
+                continue;
+            }
+        }else{
+            block->carry = tail_carry;
+            block->length = total - held - tail_carry;
+            block->lookahead = held;
+            //the next block starts with what was held back
+            intmax_t end = tail_carry + block->length;
+            tail_carry = (end < keep) ? end : keep;
+            tail_length = tail_carry + held;
+            memcpy(tail, block->data + end - tail_carry, tail_length);
+
+            pthread_mutex_lock(&ring.lock);
+            block->state = BLOCK_READ;
+            ring.num_read++;
+            pthread_cond_broadcast(&ring.changed);
+            pthread_mutex_unlock(&ring.lock);
+        }
+        if(got == 0){
+            pthread_mutex_lock(&ring.lock);
+            ring.eof = true;
+            pthread_cond_broadcast(&ring.changed);
+            pthread_mutex_unlock(&ring.lock);
+            break;
+        }
+    }
+    free(tail);
+    return NULL;
+}
+
+void * redact_blocks(void * thread_data){
     task_data *t_data = (task_data*) thread_data;
+    thread_stats* counters = &stats[t_data->id]; //only this thread writes them
+    for(;;){
+        double began = stats_clock();
+        pthread_mutex_lock(&ring.lock);
+        while(ring.num_taken == ring.num_read && !ring.eof){
+            pthread_cond_wait(&ring.changed, &ring.lock);
+        }
+        if(ring.num_taken == ring.num_read){
+            //the reader is done and every block is taken
+            pthread_mutex_unlock(&ring.lock);
+            counters->wait_time += stats_clock() - began;
+            break;
+        }
+        stream_block* block = &ring.blocks[ring.num_taken % ring.num_blocks];
+        ring.num_taken++;
+        block->state = BLOCK_WORKING;
+        pthread_mutex_unlock(&ring.lock);
+        counters->wait_time += stats_clock() - began;
 
-    char redact_char = t_data->redact_char;
-    char* pattern = t_data->pattern;
-    int pattern_length = strlen(pattern);
-    int chunk_length = (t_data->last - t_data->first) + strlen(pattern);
-    char* chunk = (char *)malloc((chunk_length + 1) * sizeof(char));
-    if(chunk == NULL){
-        fprintf(stderr, "error allocating memory of chunk");
-        exit(-1);
+        redact_block(t_data, block);
+
+        began = stats_clock();
+        pthread_mutex_lock(&ring.lock);
+        block->state = BLOCK_DONE;
+        pthread_cond_broadcast(&ring.changed);
+        pthread_mutex_unlock(&ring.lock);
+        counters->wait_time += stats_clock() - began;
     }
+    return NULL;
+}
 
-    //checks if each thread has a valid section length it has to check
-    //also checks if the last index of the chunk is in within bounds
-    if(t_data->last - t_data->first > 0 && t_data->last + pattern_length - 2 < t_data->file_size){
-        strncpy(chunk,input_text + t_data->first, chunk_length);
-        chunk[chunk_length] = '\0';
-    }else{
-        chunk[0] = '\0';
-    }   
-    //barrier to ensure thread doesnt copy manipulated data
-    pthread_barrier_wait(&barrier);
-
-    int count; 
-    int start_index = t_data->first;
-    for(int i = 0; i < strlen(chunk); i++){
-        count = 0; //keep track of how many times chunk[ptr] == pattern[ptr]
-        for(int j = 0; j < strlen(pattern); j++){
-            if(i + j >= strlen(chunk) || pattern[j] != chunk[i + j]){
-                //break if i + j passes out of bounds or chunk[ptr1] != pattern[ptr2]
-                break;
+void redact_block(task_data* t_data, stream_block* block){
+    intmax_t begin = block->carry; //first index of the block in data
+    intmax_t end = block->carry + block->length; //and past its last one
+    thread_stats* counters = &stats[t_data->id]; //only this thread writes them
+    intmax_t owned = 0; //occurences starting in the block, the carried
+                        //bytes' ones were counted by the block before
+    intmax_t overlaps = 0; //occurences starting inside an earlier one
+    intmax_t redacted = 0; //bytes filled
+    intmax_t reach = 0; //where the earlier occurences end
+    t_data->text = block->data;
+    t_data->first = 0;
+    t_data->num_matches = 0;
+    double began = stats_clock();
+    //occurences starting in the lookahead do not reach into the block
+    find_matches(t_data, block->data, end + block->lookahead, end);
+    double found = stats_clock();
+    intmax_t run_start = 0, run_end = 0;
+    for(intmax_t j = 0; j < t_data->num_matches; j++){
+        intmax_t start = t_data->matches[j].start;
+        intmax_t stop = t_data->matches[j].end;
+        if(start >= begin){
+            owned++;
+            overlaps += (start < reach);
+        }
+        reach = (stop > reach) ? stop : reach;
+        //bytes before or after the block are redacted with their own block
+        start = (start < begin) ? begin : start;
+        stop = (stop > end) ? end : stop;
+        if(stop <= start){
+            //a short pattern ending among the carried bytes
+            continue;
+        }
+        if(start > run_end){
+            redact_range(t_data, run_start, run_end);
+            redacted += run_end - run_start;
+            run_start = start;
+        }
+        run_end = (stop > run_end) ? stop : run_end;
+    }
+    redact_range(t_data, run_start, run_end);
+    redacted += run_end - run_start;
+    counters->check_time += found - began;
+    counters->redact_time += stats_clock() - found;
+    add_count(&counters->blocks, 1);
+    add_count(&counters->bytes, block->length);
+    add_count(&counters->matches, owned);
+    add_count(&counters->overlaps, overlaps);
+    add_count(&counters->redacted, redacted);
+}
+
+void * write_blocks(void * arg){
+    for(;;){
+        pthread_mutex_lock(&ring.lock);
+        stream_block* block = &ring.blocks[ring.num_written % ring.num_blocks];
+        while(block->state != BLOCK_DONE && !(ring.eof && ring.num_written == ring.num_read)){
+            pthread_cond_wait(&ring.changed, &ring.lock);
+        }
+        if(block->state != BLOCK_DONE){
+            //the reader is done and every block is written
+            pthread_mutex_unlock(&ring.lock);
+            break;
+        }
+        pthread_mutex_unlock(&ring.lock);
+
+        char* out = block->data + block->carry;
+        intmax_t left = block->length;
+        while(left > 0){
+            ssize_t written = write(STDOUT_FILENO, out, left);
+            if(written == -1 && errno == EINTR){
+                continue;
             }
-            count ++;
-        }
-        if(count == pattern_length){ 
-            //we found a pattern occurence
-            pthread_mutex_lock (&update_mutex);
-            for(int k = start_index; k < start_index + pattern_length; k++){
-                if(flag[k] == -1){
-                    //from the start index to pattern length we replace it with redact char if section hasnt
-                    //been manipulated with 
-                    (t_data->text)[k] = redact_char;
-                    flag[k] = t_data->id;
-                }else{
-                    //if text been manipulated with we check 
-                    //if the previous manipulator's id is lower than current thread id
-                    //we change current index of the input text to current redact char and
-                    //update manipulator's id to current id
-                    if(flag[k] < t_data->id){
-                        (t_data->text)[k] = redact_char;
-                        flag[k] = t_data->id;
-                    }
-                }
+            if(written <= 0){
+                fprintf(stderr, "Failed to write the output!\n");
+                exit(-1);
             }
-            pthread_mutex_unlock (&update_mutex);
+            out += written;
+            left -= written;
         }
-        start_index ++; 
+
+        pthread_mutex_lock(&ring.lock);
+        block->state = BLOCK_FREE;
+        ring.num_written++;
+        pthread_cond_broadcast(&ring.changed);
+        pthread_mutex_unlock(&ring.lock);
+    }
+    return NULL;
+}
+
+double stats_clock(void){
+#ifdef REDACT_TIMERS
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+#else
+    return 0;
+#endif
+}
+
+void add_count(intmax_t* counter, intmax_t amount){
+    __atomic_store_n(counter, *counter + amount, __ATOMIC_RELAXED);
+}
+
+void count_steals(work_pool* pool){
+    //the threads wait for the next job, their counters are not written now
+    for(int t = 0; t < num_stats; t++){
+        stats[t].stolen += pool->deques[t].stolen;
     }
-    free(chunk);
-    pthread_exit((void*)0);
-}
\ No newline at end of file
+}
+
+void * report_progress(void * arg){
+    struct timespec started, wake;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    wake = started;
+    pthread_mutex_lock(&progress.lock);
+    while(!progress.stop){
+        wake.tv_sec += (time_t)progress.interval;
+        wake.tv_nsec += (long)((progress.interval - (time_t)progress.interval) * 1e9);
+        if(wake.tv_nsec >= 1000000000L){
+            wake.tv_sec++;
+            wake.tv_nsec -= 1000000000L;
+        }
+        int waited = 0;
+        while(!progress.stop && waited != ETIMEDOUT){
+            waited = pthread_cond_timedwait(&progress.stopped, &progress.lock, &wake);
+        }
+        if(progress.stop){
+            break;
+        }
+        intmax_t bytes = 0, matches = 0;
+        for(int t = 0; t < num_stats; t++){
+            bytes += __atomic_load_n(&stats[t].bytes, __ATOMIC_RELAXED);
+            matches += __atomic_load_n(&stats[t].matches, __ATOMIC_RELAXED);
+        }
+        intmax_t total = __atomic_load_n(&progress.total, __ATOMIC_RELAXED);
+        double seconds = (wake.tv_sec - started.tv_sec) + (wake.tv_nsec - started.tv_nsec) / 1e9;
+        fprintf(stderr, "progress: %.1f MiB checked", bytes / 1048576.0);
+        if(total > 0){
+            fprintf(stderr, " of %.1f MiB", total / 1048576.0);
+        }
+        fprintf(stderr, ", %jd occurences, %.1f MiB/s\n", matches, bytes / 1048576.0 / seconds);
+    }
+    pthread_mutex_unlock(&progress.lock);
+    return NULL;
+}
+
+void print_stats(int mode, int rank, work_pool* pool, double seconds){
+    static const char* mode_names[] = {"memory", "mmap", "in-place", "stream", "batch", "mpi"};
+    thread_stats total = {0}; //sums over the threads
+    intmax_t most_bytes = 0; //bytes of the busiest thread
+    //built in memory and written at once, so processors of --mpi do not mix
+    char* report = NULL;
+    size_t report_length = 0;
+    FILE* out = open_memstream(&report, &report_length);
+    if(out == NULL){
+        fprintf(stderr, "Failed to allocate memory for stats!\n");
+        return;
+    }
+    fprintf(out, "{\"mode\": \"%s\", ", mode_names[mode]);
+    if(rank >= 0){
+        fprintf(out, "\"rank\": %d, ", rank);
+    }
+#ifdef REDACT_TIMERS
+    fprintf(out, "\"timers\": true, ");
+#else
+    fprintf(out, "\"timers\": false, ");
+#endif
+    fprintf(out, "\"seconds\": %.6f, \"threads\": [\n", seconds);
+    for(int t = 0; t < num_stats; t++){
+        thread_stats* s = &stats[t];
+        //in the pool a thread waits for the others at the end of every job
+        double wait = (pool == NULL) ? s->wait_time : pool_time - s->check_time - s->redact_time;
+        wait = (wait < 0) ? 0 : wait;
+        fprintf(out, "  {\"thread\": %d, \"blocks\": %jd, \"stolen\": %jd, \"bytes\": %jd, "
+                     "\"matches\": %jd, \"overlaps\": %jd, \"redacted\": %jd, "
+                     "\"check_seconds\": %.6f, \"redact_seconds\": %.6f, \"wait_seconds\": %.6f}%s\n",
+                t, s->blocks, s->stolen, s->bytes,
+                s->matches, s->overlaps, s->redacted, s->check_time, s->redact_time, wait,
+                (t + 1 < num_stats) ? "," : "");
+        total.blocks += s->blocks;
+        total.bytes += s->bytes;
+        total.matches += s->matches;
+        total.overlaps += s->overlaps;
+        total.redacted += s->redacted;
+        most_bytes = (s->bytes > most_bytes) ? s->bytes : most_bytes;
+    }
+    //the busiest thread against the average, 1 when the bytes are even
+    double imbalance = total.bytes ? (double)most_bytes * num_stats / total.bytes : 1;
+    fprintf(out, "], \"blocks\": %jd, \"bytes\": %jd, \"matches\": %jd, \"overlaps\": %jd, "
+                 "\"redacted\": %jd, \"imbalance\": %.3f, \"mib_per_second\": %.3f}\n",
+            total.blocks, total.bytes, total.matches, total.overlaps, total.redacted,
+            imbalance, seconds > 0 ? total.bytes / 1048576.0 / seconds : 0);
+    fclose(out);
+    fwrite(report, 1, report_length, stderr);
+    free(report);
+}